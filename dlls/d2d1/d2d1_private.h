@@ -485,6 +485,21 @@ struct d2d_curve_outline_vertex
     D2D1_POINT_2F prev, next;
 };
 
+enum d2d_geometry_buffer
+{
+    D2D_GEOMETRY_BUFFER_FILL_FACES,
+    D2D_GEOMETRY_BUFFER_FILL_VERTICES,
+    D2D_GEOMETRY_BUFFER_FILL_BEZIER_VERTICES,
+    D2D_GEOMETRY_BUFFER_FILL_ARC_VERTICES,
+    D2D_GEOMETRY_BUFFER_OUTLINE_FACES,
+    D2D_GEOMETRY_BUFFER_OUTLINE_VERTICES,
+    D2D_GEOMETRY_BUFFER_OUTLINE_BEZIER_FACES,
+    D2D_GEOMETRY_BUFFER_OUTLINE_BEZIERS,
+    D2D_GEOMETRY_BUFFER_OUTLINE_ARC_FACES,
+    D2D_GEOMETRY_BUFFER_OUTLINE_ARCS,
+    D2D_GEOMETRY_BUFFER_COUNT,
+};
+
 struct d2d_geometry
 {
     ID2D1Geometry ID2D1Geometry_iface;
@@ -539,6 +554,12 @@ struct d2d_geometry
         size_t arc_face_count;
     } outline;
 
+    struct
+    {
+        ID3D11Device1 *device;
+        ID3D11Buffer *buffers[D2D_GEOMETRY_BUFFER_COUNT];
+    } d3d;
+
     union
     {
         struct
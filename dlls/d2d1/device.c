@@ -822,11 +822,61 @@ static HRESULT d2d_device_context_update_vs_cb(struct d2d_device_context *contex
     return S_OK;
 }
 
-static void d2d_device_context_draw_geometry(struct d2d_device_context *render_target,
-        const struct d2d_geometry *geometry, struct d2d_brush *brush, float stroke_width)
+/* Geometry realizations never change once created, so the index and vertex buffers of a geometry are
+ * kept for the last device that drew it. Drawing with another device replaces them. */
+static HRESULT d2d_device_context_get_geometry_buffer(struct d2d_device_context *context,
+        const struct d2d_geometry *geometry, enum d2d_geometry_buffer idx, UINT bind_flags,
+        const void *data, size_t size, ID3D11Buffer **buffer)
 {
+    struct d2d_geometry *cache = (struct d2d_geometry *)geometry;
     D3D11_SUBRESOURCE_DATA buffer_data;
     D3D11_BUFFER_DESC buffer_desc;
+    HRESULT hr = S_OK;
+    unsigned int i;
+
+    if (context->cs)
+        EnterCriticalSection(context->cs);
+
+    if (cache->d3d.device != context->d3d_device)
+    {
+        for (i = 0; i < ARRAY_SIZE(cache->d3d.buffers); ++i)
+        {
+            if (cache->d3d.buffers[i])
+                ID3D11Buffer_Release(cache->d3d.buffers[i]);
+            cache->d3d.buffers[i] = NULL;
+        }
+        if (cache->d3d.device)
+            ID3D11Device1_Release(cache->d3d.device);
+        ID3D11Device1_AddRef(cache->d3d.device = context->d3d_device);
+    }
+
+    if (!cache->d3d.buffers[idx])
+    {
+        buffer_desc.ByteWidth = size;
+        buffer_desc.Usage = D3D11_USAGE_DEFAULT;
+        buffer_desc.BindFlags = bind_flags;
+        buffer_desc.CPUAccessFlags = 0;
+        buffer_desc.MiscFlags = 0;
+
+        buffer_data.pSysMem = data;
+        buffer_data.SysMemPitch = 0;
+        buffer_data.SysMemSlicePitch = 0;
+
+        hr = ID3D11Device1_CreateBuffer(context->d3d_device, &buffer_desc, &buffer_data, &cache->d3d.buffers[idx]);
+    }
+
+    if (SUCCEEDED(hr))
+        ID3D11Buffer_AddRef(*buffer = cache->d3d.buffers[idx]);
+
+    if (context->cs)
+        LeaveCriticalSection(context->cs);
+
+    return hr;
+}
+
+static void d2d_device_context_draw_geometry(struct d2d_device_context *render_target,
+        const struct d2d_geometry *geometry, struct d2d_brush *brush, float stroke_width)
+{
     ID3D11Buffer *ib, *vb;
     HRESULT hr;
 
@@ -842,30 +892,19 @@ static void d2d_device_context_draw_geometry(struct d2d_device_context *render_t
         return;
     }
 
-    buffer_desc.Usage = D3D11_USAGE_DEFAULT;
-    buffer_desc.CPUAccessFlags = 0;
-    buffer_desc.MiscFlags = 0;
-
-    buffer_data.SysMemPitch = 0;
-    buffer_data.SysMemSlicePitch = 0;
-
     if (geometry->outline.face_count)
     {
-        buffer_desc.ByteWidth = geometry->outline.face_count * sizeof(*geometry->outline.faces);
-        buffer_desc.BindFlags = D3D11_BIND_INDEX_BUFFER;
-        buffer_data.pSysMem = geometry->outline.faces;
-
-        if (FAILED(hr = ID3D11Device1_CreateBuffer(render_target->d3d_device, &buffer_desc, &buffer_data, &ib)))
+        if (FAILED(hr = d2d_device_context_get_geometry_buffer(render_target, geometry,
+                D2D_GEOMETRY_BUFFER_OUTLINE_FACES, D3D11_BIND_INDEX_BUFFER, geometry->outline.faces,
+                geometry->outline.face_count * sizeof(*geometry->outline.faces), &ib)))
         {
             WARN("Failed to create index buffer, hr %#lx.\n", hr);
             return;
         }
 
-        buffer_desc.ByteWidth = geometry->outline.vertex_count * sizeof(*geometry->outline.vertices);
-        buffer_desc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-        buffer_data.pSysMem = geometry->outline.vertices;
-
-        if (FAILED(hr = ID3D11Device1_CreateBuffer(render_target->d3d_device, &buffer_desc, &buffer_data, &vb)))
+        if (FAILED(hr = d2d_device_context_get_geometry_buffer(render_target, geometry,
+                D2D_GEOMETRY_BUFFER_OUTLINE_VERTICES, D3D11_BIND_VERTEX_BUFFER, geometry->outline.vertices,
+                geometry->outline.vertex_count * sizeof(*geometry->outline.vertices), &vb)))
         {
             ERR("Failed to create vertex buffer, hr %#lx.\n", hr);
             ID3D11Buffer_Release(ib);
@@ -881,21 +920,17 @@ static void d2d_device_context_draw_geometry(struct d2d_device_context *render_t
 
     if (geometry->outline.bezier_face_count)
     {
-        buffer_desc.ByteWidth = geometry->outline.bezier_face_count * sizeof(*geometry->outline.bezier_faces);
-        buffer_desc.BindFlags = D3D11_BIND_INDEX_BUFFER;
-        buffer_data.pSysMem = geometry->outline.bezier_faces;
-
-        if (FAILED(hr = ID3D11Device1_CreateBuffer(render_target->d3d_device, &buffer_desc, &buffer_data, &ib)))
+        if (FAILED(hr = d2d_device_context_get_geometry_buffer(render_target, geometry,
+                D2D_GEOMETRY_BUFFER_OUTLINE_BEZIER_FACES, D3D11_BIND_INDEX_BUFFER, geometry->outline.bezier_faces,
+                geometry->outline.bezier_face_count * sizeof(*geometry->outline.bezier_faces), &ib)))
         {
             WARN("Failed to create curves index buffer, hr %#lx.\n", hr);
             return;
         }
 
-        buffer_desc.ByteWidth = geometry->outline.bezier_count * sizeof(*geometry->outline.beziers);
-        buffer_desc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-        buffer_data.pSysMem = geometry->outline.beziers;
-
-        if (FAILED(hr = ID3D11Device1_CreateBuffer(render_target->d3d_device, &buffer_desc, &buffer_data, &vb)))
+        if (FAILED(hr = d2d_device_context_get_geometry_buffer(render_target, geometry,
+                D2D_GEOMETRY_BUFFER_OUTLINE_BEZIERS, D3D11_BIND_VERTEX_BUFFER, geometry->outline.beziers,
+                geometry->outline.bezier_count * sizeof(*geometry->outline.beziers), &vb)))
         {
             ERR("Failed to create curves vertex buffer, hr %#lx.\n", hr);
             ID3D11Buffer_Release(ib);
@@ -912,21 +947,17 @@ static void d2d_device_context_draw_geometry(struct d2d_device_context *render_t
 
     if (geometry->outline.arc_face_count)
     {
-        buffer_desc.ByteWidth = geometry->outline.arc_face_count * sizeof(*geometry->outline.arc_faces);
-        buffer_desc.BindFlags = D3D11_BIND_INDEX_BUFFER;
-        buffer_data.pSysMem = geometry->outline.arc_faces;
-
-        if (FAILED(hr = ID3D11Device1_CreateBuffer(render_target->d3d_device, &buffer_desc, &buffer_data, &ib)))
+        if (FAILED(hr = d2d_device_context_get_geometry_buffer(render_target, geometry,
+                D2D_GEOMETRY_BUFFER_OUTLINE_ARC_FACES, D3D11_BIND_INDEX_BUFFER, geometry->outline.arc_faces,
+                geometry->outline.arc_face_count * sizeof(*geometry->outline.arc_faces), &ib)))
         {
             WARN("Failed to create arcs index buffer, hr %#lx.\n", hr);
             return;
         }
 
-        buffer_desc.ByteWidth = geometry->outline.arc_count * sizeof(*geometry->outline.arcs);
-        buffer_desc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-        buffer_data.pSysMem = geometry->outline.arcs;
-
-        if (FAILED(hr = ID3D11Device1_CreateBuffer(render_target->d3d_device, &buffer_desc, &buffer_data, &vb)))
+        if (FAILED(hr = d2d_device_context_get_geometry_buffer(render_target, geometry,
+                D2D_GEOMETRY_BUFFER_OUTLINE_ARCS, D3D11_BIND_VERTEX_BUFFER, geometry->outline.arcs,
+                geometry->outline.arc_count * sizeof(*geometry->outline.arcs), &vb)))
         {
             ERR("Failed to create arcs vertex buffer, hr %#lx.\n", hr);
             ID3D11Buffer_Release(ib);
@@ -976,18 +1007,9 @@ static void STDMETHODCALLTYPE d2d_device_context_DrawGeometry(ID2D1DeviceContext
 static void d2d_device_context_fill_geometry(struct d2d_device_context *render_target,
         const struct d2d_geometry *geometry, struct d2d_brush *brush, struct d2d_brush *opacity_brush)
 {
-    D3D11_SUBRESOURCE_DATA buffer_data;
-    D3D11_BUFFER_DESC buffer_desc;
     ID3D11Buffer *ib, *vb;
     HRESULT hr;
 
-    buffer_desc.Usage = D3D11_USAGE_DEFAULT;
-    buffer_desc.CPUAccessFlags = 0;
-    buffer_desc.MiscFlags = 0;
-
-    buffer_data.SysMemPitch = 0;
-    buffer_data.SysMemSlicePitch = 0;
-
     if (FAILED(hr = d2d_device_context_update_vs_cb(render_target, &geometry->transform, 0.0f)))
     {
         WARN("Failed to update vs constant buffer, hr %#lx.\n", hr);
@@ -1002,21 +1024,17 @@ static void d2d_device_context_fill_geometry(struct d2d_device_context *render_t
 
     if (geometry->fill.face_count)
     {
-        buffer_desc.ByteWidth = geometry->fill.face_count * sizeof(*geometry->fill.faces);
-        buffer_desc.BindFlags = D3D11_BIND_INDEX_BUFFER;
-        buffer_data.pSysMem = geometry->fill.faces;
-
-        if (FAILED(hr = ID3D11Device1_CreateBuffer(render_target->d3d_device, &buffer_desc, &buffer_data, &ib)))
+        if (FAILED(hr = d2d_device_context_get_geometry_buffer(render_target, geometry,
+                D2D_GEOMETRY_BUFFER_FILL_FACES, D3D11_BIND_INDEX_BUFFER, geometry->fill.faces,
+                geometry->fill.face_count * sizeof(*geometry->fill.faces), &ib)))
         {
             WARN("Failed to create index buffer, hr %#lx.\n", hr);
             return;
         }
 
-        buffer_desc.ByteWidth = geometry->fill.vertex_count * sizeof(*geometry->fill.vertices);
-        buffer_desc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-        buffer_data.pSysMem = geometry->fill.vertices;
-
-        if (FAILED(hr = ID3D11Device1_CreateBuffer(render_target->d3d_device, &buffer_desc, &buffer_data, &vb)))
+        if (FAILED(hr = d2d_device_context_get_geometry_buffer(render_target, geometry,
+                D2D_GEOMETRY_BUFFER_FILL_VERTICES, D3D11_BIND_VERTEX_BUFFER, geometry->fill.vertices,
+                geometry->fill.vertex_count * sizeof(*geometry->fill.vertices), &vb)))
         {
             ERR("Failed to create vertex buffer, hr %#lx.\n", hr);
             ID3D11Buffer_Release(ib);
@@ -1032,11 +1050,9 @@ static void d2d_device_context_fill_geometry(struct d2d_device_context *render_t
 
     if (geometry->fill.bezier_vertex_count)
     {
-        buffer_desc.ByteWidth = geometry->fill.bezier_vertex_count * sizeof(*geometry->fill.bezier_vertices);
-        buffer_desc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-        buffer_data.pSysMem = geometry->fill.bezier_vertices;
-
-        if (FAILED(hr = ID3D11Device1_CreateBuffer(render_target->d3d_device, &buffer_desc, &buffer_data, &vb)))
+        if (FAILED(hr = d2d_device_context_get_geometry_buffer(render_target, geometry,
+                D2D_GEOMETRY_BUFFER_FILL_BEZIER_VERTICES, D3D11_BIND_VERTEX_BUFFER, geometry->fill.bezier_vertices,
+                geometry->fill.bezier_vertex_count * sizeof(*geometry->fill.bezier_vertices), &vb)))
         {
             ERR("Failed to create curves vertex buffer, hr %#lx.\n", hr);
             return;
@@ -1050,11 +1066,9 @@ static void d2d_device_context_fill_geometry(struct d2d_device_context *render_t
 
     if (geometry->fill.arc_vertex_count)
     {
-        buffer_desc.ByteWidth = geometry->fill.arc_vertex_count * sizeof(*geometry->fill.arc_vertices);
-        buffer_desc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-        buffer_data.pSysMem = geometry->fill.arc_vertices;
-
-        if (FAILED(hr = ID3D11Device1_CreateBuffer(render_target->d3d_device, &buffer_desc, &buffer_data, &vb)))
+        if (FAILED(hr = d2d_device_context_get_geometry_buffer(render_target, geometry,
+                D2D_GEOMETRY_BUFFER_FILL_ARC_VERTICES, D3D11_BIND_VERTEX_BUFFER, geometry->fill.arc_vertices,
+                geometry->fill.arc_vertex_count * sizeof(*geometry->fill.arc_vertices), &vb)))
         {
             ERR("Failed to create arc vertex buffer, hr %#lx.\n", hr);
             return;
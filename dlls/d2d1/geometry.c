@@ -2718,6 +2718,15 @@ static BOOL d2d_geometry_fill_add_arc_triangle(struct d2d_geometry *geometry,
 
 static void d2d_geometry_cleanup(struct d2d_geometry *geometry)
 {
+    unsigned int i;
+
+    for (i = 0; i < ARRAY_SIZE(geometry->d3d.buffers); ++i)
+    {
+        if (geometry->d3d.buffers[i])
+            ID3D11Buffer_Release(geometry->d3d.buffers[i]);
+    }
+    if (geometry->d3d.device)
+        ID3D11Device1_Release(geometry->d3d.device);
     free(geometry->outline.arc_faces);
     free(geometry->outline.arcs);
     free(geometry->outline.bezier_faces);
@@ -99,6 +99,61 @@ static float getieee32(const IDirectSoundBufferImpl *dsb, BYTE *base, DWORD chan
 
 const bitsgetfunc getbpp[5] = {get8, get16, get24, get32, getieee32};
 
+/* The block variants convert count samples of a single channel, src and dst
+ * advancing by istride bytes and ostride floats respectively. */
+static void get8_block(const BYTE *src, UINT istride, float *dst, UINT ostride, UINT count)
+{
+    while (count--)
+    {
+        *dst = (src[0] - 0x80) / (float)0x80;
+        src += istride;
+        dst += ostride;
+    }
+}
+
+static void get16_block(const BYTE *src, UINT istride, float *dst, UINT ostride, UINT count)
+{
+    while (count--)
+    {
+        *dst = (SHORT)le16(*(const SHORT *)src) / (float)0x8000;
+        src += istride;
+        dst += ostride;
+    }
+}
+
+static void get24_block(const BYTE *src, UINT istride, float *dst, UINT ostride, UINT count)
+{
+    while (count--)
+    {
+        LONG sample = (src[0] << 8) | (src[1] << 16) | (src[2] << 24);
+        *dst = sample / (float)0x80000000U;
+        src += istride;
+        dst += ostride;
+    }
+}
+
+static void get32_block(const BYTE *src, UINT istride, float *dst, UINT ostride, UINT count)
+{
+    while (count--)
+    {
+        *dst = (LONG)le32(*(const LONG *)src) / (float)0x80000000U;
+        src += istride;
+        dst += ostride;
+    }
+}
+
+static void getieee32_block(const BYTE *src, UINT istride, float *dst, UINT ostride, UINT count)
+{
+    while (count--)
+    {
+        *dst = *(const float *)src;
+        src += istride;
+        dst += ostride;
+    }
+}
+
+const bitsgetblockfunc getblockbpp[5] = {get8_block, get16_block, get24_block, get32_block, getieee32_block};
+
 float get_mono(const IDirectSoundBufferImpl *dsb, BYTE *base, DWORD channel)
 {
     DWORD channels = dsb->pwfx->nChannels;
@@ -140,6 +140,7 @@ void DSOUND_RecalcFormat(IDirectSoundBufferImpl *dsb)
 
 	dsb->get = dsb->get_aux;
 	dsb->put = dsb->put_aux;
+	dsb->get_block = ieee ? getblockbpp[4] : getblockbpp[dsb->pwfx->wBitsPerSample/8 - 1];
 
 	if (ichannels == ochannels)
 	{
@@ -164,6 +165,7 @@ void DSOUND_RecalcFormat(IDirectSoundBufferImpl *dsb)
 	{
 		dsb->mix_channels = 1;
 		dsb->get = get_mono;
+		dsb->get_block = NULL;
 	}
 	else if (ichannels == 2 && ochannels == 4)
 	{
@@ -286,6 +288,46 @@ static inline float get_current_sample(const IDirectSoundBufferImpl *dsb,
     return dsb->get(dsb, buffer + (mixpos % buflen), channel);
 }
 
+/**
+ * Convert count samples of one channel, starting at mixpos, into out.
+ * Equivalent to calling get_current_sample() for each of them, but converts
+ * whole runs up to the end of the buffer at once.
+ */
+static void get_current_samples(const IDirectSoundBufferImpl *dsb, BYTE *buffer, DWORD buflen,
+        DWORD mixpos, DWORD channel, float *out, UINT ostride, UINT count)
+{
+    UINT istride = dsb->pwfx->nBlockAlign;
+    UINT offset = channel * (dsb->pwfx->wBitsPerSample / 8);
+    UINT i, run;
+
+    if (!dsb->get_block)
+    {
+        for (i = 0; i < count; i++)
+            out[i * ostride] = get_current_sample(dsb, buffer, buflen, mixpos + i * istride, channel);
+        return;
+    }
+
+    while (count)
+    {
+        if (mixpos >= buflen)
+        {
+            if (!(dsb->playflags & DSBPLAY_LOOPING))
+            {
+                for (i = 0; i < count; i++)
+                    out[i * ostride] = 0.0f;
+                return;
+            }
+            mixpos %= buflen;
+        }
+
+        run = min(count, (buflen - mixpos + istride - 1) / istride);
+        dsb->get_block(buffer + mixpos + offset, istride, out, ostride, run);
+        mixpos += run * istride;
+        out += run * ostride;
+        count -= run;
+    }
+}
+
 static UINT cp_fields_noresample(IDirectSoundBufferImpl *dsb, bitsputfunc put, UINT ostride, UINT count)
 {
     UINT istride = dsb->pwfx->nBlockAlign;
@@ -300,6 +342,20 @@ static UINT cp_fields_noresample(IDirectSoundBufferImpl *dsb, bitsputfunc put, U
         committed_samples = committed_samples <= count ? committed_samples : count;
     }
 
+    if (put == putieee32 && dsb->get_block) {
+        /* Plain copy of matching channels, convert straight into tmp_buffer. */
+        float *out = dsb->device->tmp_buffer;
+        UINT out_stride = ostride / sizeof(float);
+
+        for (channel = 0; channel < dsb->mix_channels; channel++) {
+            get_current_samples(dsb, dsb->committedbuff, dsb->writelead, dsb->committed_mixpos,
+                    channel, out + channel, out_stride, committed_samples);
+            get_current_samples(dsb, dsb->buffer->memory, dsb->buflen, dsb->sec_mixpos + committed_samples * istride,
+                    channel, out + committed_samples * out_stride + channel, out_stride, count - committed_samples);
+        }
+        return count;
+    }
+
     for (i = 0; i < committed_samples; i++)
         for (channel = 0; channel < dsb->mix_channels; channel++)
             dsb->put(dsb, i * ostride, channel, get_current_sample(dsb, dsb->committedbuff,
@@ -400,12 +456,11 @@ static UINT cp_fields_resample_hq(IDirectSoundBufferImpl *dsb, bitsputfunc put,
      */
     itmp = intermediate;
     for (channel = 0; channel < channels; channel++) {
-        for (i = 0; i < committed_samples; i++)
-            *(itmp++) = get_current_sample(dsb, dsb->committedbuff,
-                dsb->writelead, dsb->committed_mixpos + i * istride, channel);
-        for (; i < required_input; i++)
-            *(itmp++) = get_current_sample(dsb, dsb->buffer->memory,
-                    dsb->buflen, dsb->sec_mixpos + i * istride, channel);
+        get_current_samples(dsb, dsb->committedbuff, dsb->writelead, dsb->committed_mixpos,
+                channel, itmp, 1, committed_samples);
+        get_current_samples(dsb, dsb->buffer->memory, dsb->buflen, dsb->sec_mixpos + committed_samples * istride,
+                channel, itmp + committed_samples, 1, required_input - committed_samples);
+        itmp += required_input;
     }
 
     for(i = 0; i < count; ++i) {
@@ -427,11 +482,18 @@ static UINT cp_fields_resample_hq(IDirectSoundBufferImpl *dsb, bitsputfunc put,
 
         for (channel = 0; channel < dsb->mix_channels; channel++) {
             int j;
-            float sum = 0.0;
+            float sum[4] = {0.0f};
             float* cache = &intermediate[channel * required_input + ipos];
-            for (j = 0; j < fir_used; j++)
-                sum += fir_copy[j] * cache[j];
-            put(dsb, i * ostride, channel, sum * dsb->firgain);
+            /* Independent partial sums let the compiler vectorize this. */
+            for (j = 0; j + 4 <= fir_used; j += 4) {
+                sum[0] += fir_copy[j] * cache[j];
+                sum[1] += fir_copy[j + 1] * cache[j + 1];
+                sum[2] += fir_copy[j + 2] * cache[j + 2];
+                sum[3] += fir_copy[j + 3] * cache[j + 3];
+            }
+            for (; j < fir_used; j++)
+                sum[0] += fir_copy[j] * cache[j];
+            put(dsb, i * ostride, channel, (sum[0] + sum[1] + sum[2] + sum[3]) * dsb->firgain);
         }
     }
 
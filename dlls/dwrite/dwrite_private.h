@@ -264,6 +264,13 @@ struct dwrite_fontface
         size_t max_size;
         size_t size;
     } cache;
+    struct
+    {
+        struct wine_rb_tree tree;
+        struct list mru;
+        size_t max_size;
+        size_t size;
+    } shaped_runs;
     CRITICAL_SECTION cs;
 
     USHORT simulations;
@@ -803,6 +810,31 @@ extern struct scriptshaping_cache *create_scriptshaping_cache(void *context,
 extern void release_scriptshaping_cache(struct scriptshaping_cache*);
 extern struct scriptshaping_cache *fontface_get_shaping_cache(struct dwrite_fontface *fontface);
 
+/* Shaping input that identifies a cached glyph run for a given font face. */
+struct shaped_run_desc
+{
+    const WCHAR *text;
+    unsigned int length;
+    DWRITE_SCRIPT_ANALYSIS sa;
+    const WCHAR *locale;
+    BOOL is_sideways;
+    BOOL is_rtl;
+};
+
+struct shaped_glyph_run
+{
+    UINT16 *clustermap;
+    DWRITE_SHAPING_TEXT_PROPERTIES *text_props;
+    UINT16 *glyphs;
+    DWRITE_SHAPING_GLYPH_PROPERTIES *glyph_props;
+    UINT32 glyph_count;
+};
+
+extern BOOL fontface_get_shaped_run(IDWriteFontFace *fontface, const struct shaped_run_desc *desc,
+        unsigned int max_glyph_count, struct shaped_glyph_run *run);
+extern void fontface_add_shaped_run(IDWriteFontFace *fontface, const struct shaped_run_desc *desc,
+        const struct shaped_glyph_run *run);
+
 extern void opentype_layout_scriptshaping_cache_init(struct scriptshaping_cache *cache);
 extern unsigned int opentype_layout_find_script(const struct scriptshaping_cache *cache, unsigned int kind,
         DWORD tag, unsigned int *script_index);
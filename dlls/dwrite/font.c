@@ -279,6 +279,145 @@ static void fontface_cache_clear(struct dwrite_fontface *fontface)
     memset(&fontface->cache, 0, sizeof(fontface->cache));
 }
 
+/* Glyph runs produced by GetGlyphs() for text layouts. Shaping does not depend on font size or measuring
+   mode, so a run could be reused across layouts as long as the text, script, direction and locale match. */
+struct shaped_run_entry
+{
+    struct wine_rb_entry entry;
+    struct list mru;
+    struct shaped_run_desc key;
+    size_t size;
+    struct shaped_glyph_run run;
+};
+
+static int fontface_shaped_run_compare(const void *k, const struct wine_rb_entry *e)
+{
+    const struct shaped_run_entry *entry = WINE_RB_ENTRY_VALUE(e, const struct shaped_run_entry, entry);
+    const struct shaped_run_desc *key = k, *key2 = &entry->key;
+    int ret;
+
+    if (key->length != key2->length) return key->length < key2->length ? -1 : 1;
+    if (key->sa.script != key2->sa.script) return (int)key->sa.script - (int)key2->sa.script;
+    if (key->sa.shapes != key2->sa.shapes) return (int)key->sa.shapes - (int)key2->sa.shapes;
+    if (key->is_sideways != key2->is_sideways) return key->is_sideways ? 1 : -1;
+    if (key->is_rtl != key2->is_rtl) return key->is_rtl ? 1 : -1;
+    if ((ret = memcmp(key->text, key2->text, key->length * sizeof(*key->text)))) return ret;
+    return wcscmp(key->locale ? key->locale : L"", key2->locale);
+}
+
+static void fontface_shaped_runs_init(struct dwrite_fontface *fontface)
+{
+    wine_rb_init(&fontface->shaped_runs.tree, fontface_shaped_run_compare);
+    list_init(&fontface->shaped_runs.mru);
+    fontface->shaped_runs.max_size = 0x10000;
+}
+
+static void fontface_shaped_runs_clear(struct dwrite_fontface *fontface)
+{
+    struct shaped_run_entry *entry, *entry2;
+
+    LIST_FOR_EACH_ENTRY_SAFE(entry, entry2, &fontface->shaped_runs.mru, struct shaped_run_entry, mru)
+    {
+        list_remove(&entry->mru);
+        free(entry);
+    }
+    memset(&fontface->shaped_runs, 0, sizeof(fontface->shaped_runs));
+}
+
+BOOL fontface_get_shaped_run(IDWriteFontFace *iface, const struct shaped_run_desc *desc,
+        unsigned int max_glyph_count, struct shaped_glyph_run *run)
+{
+    struct dwrite_fontface *fontface = unsafe_impl_from_IDWriteFontFace(iface);
+    struct shaped_run_entry *entry;
+    struct wine_rb_entry *e;
+    BOOL found = FALSE;
+
+    if (!fontface) return FALSE;
+
+    EnterCriticalSection(&fontface->cs);
+    if ((e = wine_rb_get(&fontface->shaped_runs.tree, desc)))
+    {
+        entry = WINE_RB_ENTRY_VALUE(e, struct shaped_run_entry, entry);
+        if (entry->run.glyph_count <= max_glyph_count)
+        {
+            memcpy(run->clustermap, entry->run.clustermap, desc->length * sizeof(*run->clustermap));
+            memcpy(run->text_props, entry->run.text_props, desc->length * sizeof(*run->text_props));
+            memcpy(run->glyphs, entry->run.glyphs, entry->run.glyph_count * sizeof(*run->glyphs));
+            memcpy(run->glyph_props, entry->run.glyph_props, entry->run.glyph_count * sizeof(*run->glyph_props));
+            run->glyph_count = entry->run.glyph_count;
+
+            list_remove(&entry->mru);
+            list_add_head(&fontface->shaped_runs.mru, &entry->mru);
+            found = TRUE;
+        }
+    }
+    LeaveCriticalSection(&fontface->cs);
+
+    return found;
+}
+
+void fontface_add_shaped_run(IDWriteFontFace *iface, const struct shaped_run_desc *desc,
+        const struct shaped_glyph_run *run)
+{
+    struct dwrite_fontface *fontface = unsafe_impl_from_IDWriteFontFace(iface);
+    const WCHAR *locale = desc->locale ? desc->locale : L"";
+    struct shaped_run_entry *entry, *old_entry;
+    size_t locale_len, size;
+    BYTE *ptr;
+
+    if (!fontface) return;
+
+    /* All arrays are 16-bit wide, pack them right after the entry. */
+    locale_len = wcslen(locale) + 1;
+    size = sizeof(*entry) + (desc->length * 2 + locale_len) * sizeof(WCHAR)
+            + desc->length * sizeof(*run->text_props) + run->glyph_count * (sizeof(*run->glyphs) + sizeof(*run->glyph_props));
+    if (size > fontface->shaped_runs.max_size / 4)
+        return;
+
+    if (!(entry = calloc(1, size))) return;
+    entry->size = size;
+    ptr = (BYTE *)(entry + 1);
+
+    entry->key = *desc;
+    entry->key.text = memcpy(ptr, desc->text, desc->length * sizeof(*desc->text));
+    ptr += desc->length * sizeof(*desc->text);
+    entry->key.locale = memcpy(ptr, locale, locale_len * sizeof(*locale));
+    ptr += locale_len * sizeof(*locale);
+    entry->run.clustermap = memcpy(ptr, run->clustermap, desc->length * sizeof(*run->clustermap));
+    ptr += desc->length * sizeof(*run->clustermap);
+    entry->run.text_props = memcpy(ptr, run->text_props, desc->length * sizeof(*run->text_props));
+    ptr += desc->length * sizeof(*run->text_props);
+    entry->run.glyphs = memcpy(ptr, run->glyphs, run->glyph_count * sizeof(*run->glyphs));
+    ptr += run->glyph_count * sizeof(*run->glyphs);
+    entry->run.glyph_props = memcpy(ptr, run->glyph_props, run->glyph_count * sizeof(*run->glyph_props));
+    entry->run.glyph_count = run->glyph_count;
+
+    EnterCriticalSection(&fontface->cs);
+
+    while (fontface->shaped_runs.size + size > fontface->shaped_runs.max_size
+            && !list_empty(&fontface->shaped_runs.mru))
+    {
+        old_entry = LIST_ENTRY(list_tail(&fontface->shaped_runs.mru), struct shaped_run_entry, mru);
+        fontface->shaped_runs.size -= old_entry->size;
+        wine_rb_remove(&fontface->shaped_runs.tree, &old_entry->entry);
+        list_remove(&old_entry->mru);
+        free(old_entry);
+    }
+
+    if (wine_rb_put(&fontface->shaped_runs.tree, &entry->key, &entry->entry) == -1)
+    {
+        /* Another thread got here first. */
+        free(entry);
+    }
+    else
+    {
+        list_add_head(&fontface->shaped_runs.mru, &entry->mru);
+        fontface->shaped_runs.size += size;
+    }
+
+    LeaveCriticalSection(&fontface->cs);
+}
+
 struct dwrite_font_propvec {
     FLOAT stretch;
     FLOAT style;
@@ -889,6 +1028,7 @@ static ULONG WINAPI dwritefontface_Release(IDWriteFontFace5 *iface)
             IDWriteFontFileStream_Release(fontface->stream);
         }
         fontface_cache_clear(fontface);
+        fontface_shaped_runs_clear(fontface);
 
         dwrite_cmap_release(&fontface->cmap);
         IDWriteFactory7_Release(fontface->factory);
@@ -5502,6 +5642,7 @@ HRESULT create_fontface(const struct fontface_desc *desc, struct list *cached_li
     IDWriteFontFileStream_AddRef(fontface->stream);
     InitializeCriticalSection(&fontface->cs);
     fontface_cache_init(fontface);
+    fontface_shaped_runs_init(fontface);
 
     stream_desc.stream = fontface->stream;
     stream_desc.face_type = desc->face_type;
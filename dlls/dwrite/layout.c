@@ -947,6 +947,8 @@ failed:
 static HRESULT layout_shape_get_glyphs(struct dwrite_textlayout *layout, struct shaping_context *context)
 {
     struct regular_layout_run *run = context->run;
+    struct shaped_glyph_run shaped;
+    struct shaped_run_desc desc;
     unsigned int max_count;
     HRESULT hr;
 
@@ -968,6 +970,28 @@ static HRESULT layout_shape_get_glyphs(struct dwrite_textlayout *layout, struct
     if (FAILED(hr = layout_shape_get_user_features(layout, context)))
         return hr;
 
+    /* Runs without user features are looked up in per-fontface cache first. */
+    desc.text = run->descr.string;
+    desc.length = run->descr.stringLength;
+    desc.sa = run->sa;
+    desc.locale = run->descr.localeName;
+    desc.is_sideways = run->run.isSideways;
+    desc.is_rtl = run->run.bidiLevel & 1;
+
+    shaped.clustermap = run->clustermap;
+    shaped.text_props = context->text_props;
+    shaped.glyphs = run->glyphs;
+    shaped.glyph_props = context->glyph_props;
+
+    if (!context->user_features.range_count
+            && fontface_get_shaped_run(run->run.fontFace, &desc, max_count, &shaped))
+    {
+        run->glyphcount = shaped.glyph_count;
+        run->run.glyphIndices = run->glyphs;
+        run->descr.clusterMap = run->clustermap;
+        return S_OK;
+    }
+
     for (;;)
     {
         hr = IDWriteTextAnalyzer2_GetGlyphs(context->analyzer, run->descr.string, run->descr.stringLength, run->run.fontFace,
@@ -998,6 +1022,13 @@ static HRESULT layout_shape_get_glyphs(struct dwrite_textlayout *layout, struct
 
     if (FAILED(hr))
         WARN("%s: shaping failed, hr %#lx.\n", debugstr_rundescr(&run->descr), hr);
+    else if (!context->user_features.range_count)
+    {
+        shaped.glyphs = run->glyphs;
+        shaped.glyph_props = context->glyph_props;
+        shaped.glyph_count = run->glyphcount;
+        fontface_add_shaped_run(run->run.fontFace, &desc, &shaped);
+    }
 
     run->run.glyphIndices = run->glyphs;
     run->descr.clusterMap = run->clustermap;
@@ -1188,13 +1188,27 @@ static DWORD WINAPI copy_progress_cb(LARGE_INTEGER total_size, LARGE_INTEGER tot
     return PROGRESS_CANCEL;
 }
 
+static DWORD WINAPI copy_chunk_progress_cb(LARGE_INTEGER total_size, LARGE_INTEGER total_transferred,
+                                           LARGE_INTEGER stream_size, LARGE_INTEGER stream_transferred,
+                                           DWORD stream, DWORD reason, HANDLE source, HANDLE dest, LPVOID userdata)
+{
+    DWORD *chunks = userdata;
+
+    if (reason == CALLBACK_STREAM_SWITCH) return PROGRESS_CONTINUE;
+    ok(reason == CALLBACK_CHUNK_FINISHED, "expected CALLBACK_CHUNK_FINISHED, got %lu\n", reason);
+    ok(total_transferred.QuadPart > 0, "got transferred %s\n", wine_dbgstr_longlong(total_transferred.QuadPart));
+    (*chunks)++;
+    return PROGRESS_CANCEL;
+}
+
 static void test_CopyFileEx(void)
 {
     char temp_path[MAX_PATH];
     char source[MAX_PATH], dest[MAX_PATH];
     static const char prefix[] = "pfx";
     HANDLE hfile;
-    DWORD ret;
+    DWORD ret, chunks;
+    char *buffer;
     BOOL retok;
 
     ret = GetTempPathA(MAX_PATH, temp_path);
@@ -1224,6 +1238,23 @@ static void test_CopyFileEx(void)
     ok(GetLastError() == ERROR_REQUEST_ABORTED, "expected ERROR_REQUEST_ABORTED, got %ld\n", GetLastError());
     ok(GetFileAttributesA(dest) == INVALID_FILE_ATTRIBUTES, "file was not deleted\n");
 
+    /* cancel once some data has been copied */
+    hfile = CreateFileA(source, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, 0, 0);
+    ok(hfile != INVALID_HANDLE_VALUE, "failed to open source file, error %ld\n", GetLastError());
+    buffer = HeapAlloc(GetProcessHeap(), HEAP_ZERO_MEMORY, 0x40000);
+    retok = WriteFile(hfile, buffer, 0x40000, &ret, NULL);
+    ok(retok && ret == 0x40000, "WriteFile failed, error %ld\n", GetLastError());
+    HeapFree(GetProcessHeap(), 0, buffer);
+    CloseHandle(hfile);
+
+    chunks = 0;
+    SetLastError(0xdeadbeef);
+    retok = CopyFileExA(source, dest, copy_chunk_progress_cb, &chunks, NULL, 0);
+    ok(!retok, "CopyFileExA unexpectedly succeeded\n");
+    ok(GetLastError() == ERROR_REQUEST_ABORTED, "expected ERROR_REQUEST_ABORTED, got %ld\n", GetLastError());
+    ok(chunks == 1, "got %lu chunks\n", chunks);
+    ok(GetFileAttributesA(dest) == INVALID_FILE_ATTRIBUTES, "file was not deleted\n");
+
     retok = CopyFileExA(source, NULL, copy_progress_cb, hfile, NULL, 0);
     ok(!retok, "CopyFileExA unexpectedly succeeded\n");
     ok(GetLastError() == ERROR_PATH_NOT_FOUND, "expected ERROR_PATH_NOT_FOUND, got %ld\n", GetLastError());
@@ -488,6 +488,32 @@ BOOL WINAPI DECLSPEC_HOTPATCH AreFileApisANSI(void)
     return !oem_file_apis;
 }
 
+/* report the progress of a file copy; returns FALSE if the copy was aborted */
+static BOOL report_copy_progress( LPPROGRESS_ROUTINE *progress, LARGE_INTEGER size, LARGE_INTEGER transferred,
+                                  DWORD reason, HANDLE h1, HANDLE h2, void *param )
+{
+    DWORD cbret;
+
+    if (!*progress) return TRUE;
+
+    cbret = (*progress)( size, transferred, size, transferred, 1, reason, h1, h2, param );
+    if (cbret == PROGRESS_QUIET)
+        *progress = NULL;
+    else if (cbret == PROGRESS_STOP)
+    {
+        SetLastError( ERROR_REQUEST_ABORTED );
+        return FALSE;
+    }
+    else if (cbret == PROGRESS_CANCEL)
+    {
+        BOOLEAN disp = TRUE;
+        SetFileInformationByHandle( h2, FileDispositionInfo, &disp, sizeof(disp) );
+        SetLastError( ERROR_REQUEST_ABORTED );
+        return FALSE;
+    }
+    return TRUE;
+}
+
 /******************************************************************************
  *  copy_file
  */
@@ -499,6 +525,7 @@ static BOOL copy_file( const WCHAR *source, const WCHAR *dest, COPYFILE2_EXTENDE
     PCOPYFILE2_PROGRESS_ROUTINE progress2 = params ? params->pProgressRoutine : NULL;
 
     static const int buffer_size = 65536;
+    static const LONGLONG extents_chunk_size = 64 << 20;
     HANDLE h1, h2;
     FILE_NETWORK_OPEN_INFORMATION info;
     FILE_BASIC_INFORMATION basic_info;
@@ -508,7 +535,6 @@ static BOOL copy_file( const WCHAR *source, const WCHAR *dest, COPYFILE2_EXTENDE
     char *buffer;
     LARGE_INTEGER size;
     LARGE_INTEGER transferred;
-    DWORD cbret;
     DWORD source_access = GENERIC_READ;
 
     if (cancel_ptr)
@@ -590,24 +616,30 @@ static BOOL copy_file( const WCHAR *source, const WCHAR *dest, COPYFILE2_EXTENDE
     size = info.EndOfFile;
     transferred.QuadPart = 0;
 
-    if (progress)
+    if (!report_copy_progress( &progress, size, transferred, CALLBACK_STREAM_SWITCH, h1, h2, param ))
+        goto done;
+
+    /* let the file system share or copy the data without going through our buffer */
+    while (transferred.QuadPart < size.QuadPart)
     {
-        cbret = progress( size, transferred, size, transferred, 1,
-                          CALLBACK_STREAM_SWITCH, h1, h2, param );
-        if (cbret == PROGRESS_QUIET)
-            progress = NULL;
-        else if (cbret == PROGRESS_STOP)
-        {
-            SetLastError( ERROR_REQUEST_ABORTED );
-            goto done;
-        }
-        else if (cbret == PROGRESS_CANCEL)
-        {
-            BOOLEAN disp = TRUE;
-            SetFileInformationByHandle( h2, FileDispositionInfo, &disp, sizeof(disp) );
-            SetLastError( ERROR_REQUEST_ABORTED );
+        DUPLICATE_EXTENTS_DATA extents;
+
+        extents.FileHandle = h1;
+        extents.SourceFileOffset = transferred;
+        extents.TargetFileOffset = transferred;
+        extents.ByteCount.QuadPart = min( size.QuadPart - transferred.QuadPart, extents_chunk_size );
+        if (NtFsControlFile( h2, NULL, NULL, NULL, &io, FSCTL_DUPLICATE_EXTENTS_TO_FILE,
+                             &extents, sizeof(extents), NULL, 0 ))
+            break;
+        transferred.QuadPart += extents.ByteCount.QuadPart;
+        if (!report_copy_progress( &progress, size, transferred, CALLBACK_CHUNK_FINISHED, h1, h2, param ))
             goto done;
-        }
+    }
+    if (transferred.QuadPart)
+    {
+        /* copy whatever is left the usual way */
+        SetFilePointerEx( h1, transferred, NULL, FILE_BEGIN );
+        SetFilePointerEx( h2, transferred, NULL, FILE_BEGIN );
     }
 
     while (ReadFile( h1, buffer, buffer_size, &count, NULL ) && count)
@@ -620,26 +652,9 @@ static BOOL copy_file( const WCHAR *source, const WCHAR *dest, COPYFILE2_EXTENDE
             p += res;
             count -= res;
 
-            if (progress)
-            {
-                transferred.QuadPart += res;
-                cbret = progress( size, transferred, size, transferred, 1,
-                                  CALLBACK_CHUNK_FINISHED, h1, h2, param );
-                if (cbret == PROGRESS_QUIET)
-                    progress = NULL;
-                else if (cbret == PROGRESS_STOP)
-                {
-                    SetLastError( ERROR_REQUEST_ABORTED );
-                    goto done;
-                }
-                else if (cbret == PROGRESS_CANCEL)
-                {
-                    BOOLEAN disp = TRUE;
-                    SetFileInformationByHandle( h2, FileDispositionInfo, &disp, sizeof(disp) );
-                    SetLastError( ERROR_REQUEST_ABORTED );
-                    goto done;
-                }
-            }
+            transferred.QuadPart += res;
+            if (!report_copy_progress( &progress, size, transferred, CALLBACK_CHUNK_FINISHED, h1, h2, param ))
+                goto done;
         }
     }
     ret = TRUE;
@@ -322,6 +322,184 @@ static void test_ntncdf_async(void)
     CloseHandle(hEvent);
 }
 
+static void test_ntncdf_coalesce(void)
+{
+    NTSTATUS r;
+    HANDLE hdir, hfile, hEvent;
+    char buffer[0x1000];
+    DWORD fflags, filter, written;
+    IO_STATUS_BLOCK iosb;
+    WCHAR path[MAX_PATH], file[MAX_PATH];
+    PFILE_NOTIFY_INFORMATION pfni;
+    BOOL ret, found;
+    int i;
+
+    r = GetTempPathW( MAX_PATH, path );
+    ok( r != 0, "temp path failed\n");
+    if (!r)
+        return;
+
+    lstrcatW( path, L"\\coo" );
+    lstrcpyW( file, path );
+    lstrcatW( file, L"\\foo" );
+
+    DeleteFileW( file );
+    RemoveDirectoryW( path );
+
+    ret = CreateDirectoryW( path, NULL );
+    ok( ret, "failed to create directory\n" );
+
+    hfile = CreateFileW( file, GENERIC_WRITE, FILE_SHARE_READ, NULL, CREATE_ALWAYS, 0, NULL );
+    ok( hfile != INVALID_HANDLE_VALUE, "failed to create file\n" );
+
+    fflags = FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED;
+    hdir = CreateFileW( path, GENERIC_READ|SYNCHRONIZE, FILE_SHARE_READ, NULL,
+                        OPEN_EXISTING, fflags, NULL );
+    ok( hdir != INVALID_HANDLE_VALUE, "failed to open directory\n" );
+
+    hEvent = CreateEventA( NULL, 0, 0, NULL );
+    filter = FILE_NOTIFY_CHANGE_SIZE | FILE_NOTIFY_CHANGE_LAST_WRITE;
+
+    r = pNtNotifyChangeDirectoryFile( hdir, hEvent, NULL, NULL, &iosb, buffer, sizeof buffer, filter, 0 );
+    ok( r == STATUS_PENDING, "got %#lx\n", r );
+
+    ret = WriteFile( hfile, "data", 4, &written, NULL );
+    ok( ret, "WriteFile failed, error %lu\n", GetLastError() );
+
+    r = WaitForSingleObject( hEvent, 1000 );
+    ok( r == WAIT_OBJECT_0, "got %#lx\n", r );
+    ok( iosb.Status == STATUS_SUCCESS, "got status %#lx\n", iosb.Status );
+
+    /* queue a burst of modifications while no request is pending */
+    for (i = 0; i < 16; i++)
+    {
+        ret = WriteFile( hfile, "data", 4, &written, NULL );
+        ok( ret, "WriteFile failed, error %lu\n", GetLastError() );
+    }
+
+    r = pNtNotifyChangeDirectoryFile( hdir, hEvent, NULL, NULL, &iosb, buffer, sizeof buffer, filter, 0 );
+    ok( r == STATUS_PENDING, "got %#lx\n", r );
+
+    r = WaitForSingleObject( hEvent, 1000 );
+    ok( r == WAIT_OBJECT_0, "got %#lx\n", r );
+    ok( iosb.Status == STATUS_SUCCESS, "got status %#lx\n", iosb.Status );
+    ok( iosb.Information != 0, "got no data\n" );
+
+    pfni = (PFILE_NOTIFY_INFORMATION)buffer;
+    found = FALSE;
+    while (iosb.Information)
+    {
+        if (pfni->Action == FILE_ACTION_MODIFIED && pfni->FileNameLength == 6 &&
+            !memcmp( pfni->FileName, L"foo", 6 ))
+            found = TRUE;
+        if (!pfni->NextEntryOffset) break;
+        pfni = (PFILE_NOTIFY_INFORMATION)((char *)pfni + pfni->NextEntryOffset);
+    }
+    ok( found, "no modification record for foo\n" );
+
+    CloseHandle( hfile );
+    CloseHandle( hdir );
+    CloseHandle( hEvent );
+
+    ret = DeleteFileW( file );
+    ok( ret, "failed to delete file\n" );
+    ret = RemoveDirectoryW( path );
+    ok( ret, "failed to remove directory\n" );
+}
+
+static void test_ntncdf_overflow(void)
+{
+    NTSTATUS r;
+    HANDLE hdir, hfile, hEvent;
+    ULONG size = 0x400000;
+    DWORD fflags, filter;
+    IO_STATUS_BLOCK iosb;
+    WCHAR path[MAX_PATH], name1[MAX_PATH], name2[MAX_PATH];
+    char *buffer;
+    BOOL ret;
+    int i, len;
+
+    r = GetTempPathW( MAX_PATH, path );
+    ok( r != 0, "temp path failed\n");
+    if (!r)
+        return;
+
+    lstrcatW( path, L"\\ovf" );
+
+    /* long names, so that a few thousand renames queue more than the server keeps */
+    len = lstrlenW( path );
+    if (len + 202 > MAX_PATH)
+    {
+        skip( "temp path %s too long\n", wine_dbgstr_w( path ) );
+        return;
+    }
+    lstrcpyW( name1, path );
+    name1[len] = '\\';
+    for (i = len + 1; i < len + 201; i++) name1[i] = 'a';
+    name1[i] = 0;
+    lstrcpyW( name2, name1 );
+    name2[len + 1] = 'b';
+
+    DeleteFileW( name1 );
+    DeleteFileW( name2 );
+    RemoveDirectoryW( path );
+
+    ret = CreateDirectoryW( path, NULL );
+    ok( ret, "failed to create directory\n" );
+
+    fflags = FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED;
+    hdir = CreateFileW( path, GENERIC_READ|SYNCHRONIZE, FILE_SHARE_READ, NULL,
+                        OPEN_EXISTING, fflags, NULL );
+    ok( hdir != INVALID_HANDLE_VALUE, "failed to open directory\n" );
+
+    hEvent = CreateEventA( NULL, 0, 0, NULL );
+    buffer = HeapAlloc( GetProcessHeap(), 0, size );
+    filter = FILE_NOTIFY_CHANGE_FILE_NAME;
+
+    r = pNtNotifyChangeDirectoryFile( hdir, hEvent, NULL, NULL, &iosb, buffer, size, filter, 0 );
+    ok( r == STATUS_PENDING, "got %#lx\n", r );
+
+    hfile = CreateFileW( name1, GENERIC_WRITE, 0, NULL, CREATE_NEW, 0, NULL );
+    ok( hfile != INVALID_HANDLE_VALUE, "failed to create file\n" );
+    CloseHandle( hfile );
+
+    r = WaitForSingleObject( hEvent, 1000 );
+    ok( r == WAIT_OBJECT_0, "got %#lx\n", r );
+    ok( iosb.Status == STATUS_SUCCESS, "got status %#lx\n", iosb.Status );
+
+    /* queue more than 1 MiB of rename records while no request is pending; this
+     * is above the amount the server keeps, but still fits in the client buffer */
+    for (i = 0; i < 3000; i++)
+    {
+        if (!(ret = MoveFileW( i % 2 ? name2 : name1, i % 2 ? name1 : name2 ))) break;
+    }
+    ok( ret, "MoveFileW failed, error %lu\n", GetLastError() );
+
+    iosb.Status = 0xdeadbeef;
+    iosb.Information = 0xdeadbeef;
+    r = pNtNotifyChangeDirectoryFile( hdir, hEvent, NULL, NULL, &iosb, buffer, size, filter, 0 );
+    ok( r == STATUS_PENDING || r == STATUS_NOTIFY_ENUM_DIR, "got %#lx\n", r );
+
+    r = WaitForSingleObject( hEvent, 5000 );
+    ok( r == WAIT_OBJECT_0, "got %#lx\n", r );
+    /* the records fit in the buffer, but the server may drop them and ask for a rescan */
+    ok( iosb.Status == STATUS_NOTIFY_ENUM_DIR || iosb.Status == STATUS_SUCCESS,
+        "got status %#lx\n", iosb.Status );
+    if (iosb.Status == STATUS_SUCCESS)
+        ok( iosb.Information > 0x100000, "got info %#Ix\n", iosb.Information );
+    else
+        ok( iosb.Information == 0, "got info %#Ix\n", iosb.Information );
+
+    CloseHandle( hdir );
+    CloseHandle( hEvent );
+    HeapFree( GetProcessHeap(), 0, buffer );
+
+    ret = DeleteFileW( i % 2 ? name2 : name1 );
+    ok( ret, "failed to delete file\n" );
+    ret = RemoveDirectoryW( path );
+    ok( ret, "failed to remove directory\n" );
+}
+
 START_TEST(change)
 {
     HMODULE hntdll = GetModuleHandleA("ntdll");
@@ -337,4 +515,6 @@ START_TEST(change)
 
     test_ntncdf();
     test_ntncdf_async();
+    test_ntncdf_coalesce();
+    test_ntncdf_overflow();
 }
@@ -5599,6 +5599,77 @@ static void test_ioctl(void)
     CloseHandle(file);
 }
 
+static void test_duplicate_extents(void)
+{
+    static const ULONG chunk_size = 0x10000;
+    char path[MAX_PATH], src_name[MAX_PATH], dst_name[MAX_PATH];
+    DUPLICATE_EXTENTS_DATA extents;
+    IO_STATUS_BLOCK iosb;
+    HANDLE src, dst;
+    NTSTATUS status;
+    char *buffer;
+    DWORD size;
+    BOOL ret;
+    int i;
+
+    GetTempPathA(MAX_PATH, path);
+    GetTempFileNameA(path, "foo", 0, src_name);
+    GetTempFileNameA(path, "foo", 0, dst_name);
+    src = CreateFileA(src_name, GENERIC_READ | GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, 0, 0);
+    ok(src != INVALID_HANDLE_VALUE, "failed to create source file, error %lu\n", GetLastError());
+    dst = CreateFileA(dst_name, GENERIC_READ | GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, 0, 0);
+    ok(dst != INVALID_HANDLE_VALUE, "failed to create destination file, error %lu\n", GetLastError());
+
+    buffer = HeapAlloc(GetProcessHeap(), 0, 3 * chunk_size);
+    for (i = 0; i < 3; i++) memset(buffer + i * chunk_size, 'a' + i, chunk_size);
+    ret = WriteFile(src, buffer, 3 * chunk_size, &size, NULL);
+    ok(ret && size == 3 * chunk_size, "WriteFile failed, error %lu\n", GetLastError());
+
+    /* the target range has to exist already */
+    SetFilePointer(dst, 3 * chunk_size, NULL, FILE_BEGIN);
+    ret = SetEndOfFile(dst);
+    ok(ret, "SetEndOfFile failed, error %lu\n", GetLastError());
+
+    extents.FileHandle = src;
+    extents.SourceFileOffset.QuadPart = 0;
+    extents.TargetFileOffset.QuadPart = 0;
+    extents.ByteCount.QuadPart = 3 * chunk_size;
+    status = pNtFsControlFile(dst, NULL, NULL, NULL, &iosb, FSCTL_DUPLICATE_EXTENTS_TO_FILE,
+                              &extents, sizeof(extents), NULL, 0);
+    if (status == STATUS_INVALID_DEVICE_REQUEST || status == STATUS_NOT_SUPPORTED)
+    {
+        skip("FSCTL_DUPLICATE_EXTENTS_TO_FILE is not supported, status %#lx\n", status);
+        goto done;
+    }
+    ok(status == STATUS_SUCCESS, "got %#lx\n", status);
+
+    /* clone the first chunk over the last one */
+    extents.SourceFileOffset.QuadPart = 0;
+    extents.TargetFileOffset.QuadPart = 2 * chunk_size;
+    extents.ByteCount.QuadPart = chunk_size;
+    status = pNtFsControlFile(dst, NULL, NULL, NULL, &iosb, FSCTL_DUPLICATE_EXTENTS_TO_FILE,
+                              &extents, sizeof(extents), NULL, 0);
+    ok(status == STATUS_SUCCESS, "got %#lx\n", status);
+
+    size = GetFileSize(dst, NULL);
+    ok(size == 3 * chunk_size, "got size %#lx\n", size);
+
+    memset(buffer, 0, 3 * chunk_size);
+    SetFilePointer(dst, 0, NULL, FILE_BEGIN);
+    ret = ReadFile(dst, buffer, 3 * chunk_size, &size, NULL);
+    ok(ret && size == 3 * chunk_size, "ReadFile failed, error %lu\n", GetLastError());
+    for (i = 0; i < 3 * chunk_size; i++)
+        if (buffer[i] != (i < 2 * chunk_size ? 'a' + i / chunk_size : 'a')) break;
+    ok(i == 3 * chunk_size, "contents differ at offset %#x\n", i);
+
+done:
+    HeapFree(GetProcessHeap(), 0, buffer);
+    CloseHandle(src);
+    CloseHandle(dst);
+    DeleteFileA(src_name);
+    DeleteFileA(dst_name);
+}
+
 static void test_flush_buffers_file(void)
 {
     char path[MAX_PATH], buffer[MAX_PATH];
@@ -6507,6 +6578,7 @@ START_TEST(file)
     test_query_volume_information_file();
     test_query_attribute_information_file();
     test_ioctl();
+    test_duplicate_extents();
     test_query_ea();
     test_flush_buffers_file();
     test_reparse_points();
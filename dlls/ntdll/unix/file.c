@@ -1862,8 +1862,9 @@ static NTSTATUS fd_set_file_info( int fd, UINT attr, BOOL force_set_xattr )
 }
 
 
-/* get the stat info and file attributes for a file (by name) */
-static int get_file_info( const char *path, struct stat *st, ULONG *attr )
+/* get the stat info and file attributes for a file (by name), optionally in a known parent directory */
+static int get_dir_entry_info( const char *path, const struct file_identity *parent,
+                               struct stat *st, ULONG *attr )
 {
     char *parent_path;
     char attr_data[65];
@@ -1886,6 +1887,12 @@ static int get_file_info( const char *path, struct stat *st, ULONG *attr )
         if (is_reparse_dir( AT_FDCWD, path, &is_dir ) == 0)
             st->st_mode = (st->st_mode & ~S_IFMT) | (is_dir ? S_IFDIR : S_IFREG);
     }
+    else if (S_ISDIR( st->st_mode ) && parent)
+    {
+        /* consider mount points to be reparse points (IO_REPARSE_TAG_MOUNT_POINT) */
+        if (st->st_dev != parent->dev || st->st_ino == parent->ino)
+            *attr |= FILE_ATTRIBUTE_REPARSE_POINT;
+    }
     else if (S_ISDIR( st->st_mode ) && (parent_path = malloc( strlen(path) + 4 )))
     {
         struct stat parent_st;
@@ -1919,6 +1926,13 @@ static int get_file_info( const char *path, struct stat *st, ULONG *attr )
 }
 
 
+/* get the stat info and file attributes for a file (by name) */
+static int get_file_info( const char *path, struct stat *st, ULONG *attr )
+{
+    return get_dir_entry_info( path, NULL, st, attr );
+}
+
+
 #if defined(__ANDROID__) && !defined(HAVE_FUTIMENS)
 static int futimens( int fd, const struct timespec spec[2] )
 {
@@ -2445,11 +2459,23 @@ static NTSTATUS get_dir_data_entry( struct dir_data *dir_data, void *info_ptr, I
                                     union file_directory_info **last_info )
 {
     const struct dir_data_names *names = &dir_data->names[dir_data->pos];
+    const struct file_identity *parent = NULL;
     union file_directory_info *info;
     struct stat st;
-    ULONG name_len, start, dir_size, attributes;
+    ULONG name_len, start, dir_size, attributes = 0;
+    int ret;
+
+    /* entries other than "." and ".." live in the directory being listed */
+    if (strcmp( names->unix_name, "." ) && strcmp( names->unix_name, ".." )) parent = &dir_data->id;
 
-    if (get_file_info( names->unix_name, &st, &attributes ) == -1)
+    if (class == FileNamesInformation)
+    {
+        /* only the name is returned, the existence and identity of the file are enough */
+        if ((ret = stat( names->unix_name, &st )) == -1) ret = lstat( names->unix_name, &st );
+    }
+    else ret = get_dir_entry_info( names->unix_name, parent, &st, &attributes );
+
+    if (ret == -1)
     {
         TRACE( "file no longer exists %s\n", names->unix_name );
         return STATUS_SUCCESS;
@@ -2914,6 +2940,231 @@ NTSTATUS WINAPI NtQueryDirectoryFile( HANDLE handle, HANDLE event, PIO_APC_ROUTI
 }
 
 
+/* per-process cache of directory contents for case-insensitive lookups */
+struct dir_lookup_name
+{
+    unsigned int hash;               /* case-insensitive hash of the Unicode name */
+    unsigned int next;               /* next name in the same bucket, or ~0u */
+    unsigned int len;                /* length of the Unicode name */
+    unsigned int name;               /* offset of the Unicode name in the names buffer */
+    unsigned int unix_name;          /* offset of the Unix name in the Unix names buffer */
+};
+
+struct dir_lookup_cache
+{
+    dev_t                   dev;     /* device of the directory */
+    ino_t                   ino;     /* inode of the directory */
+    time_t                  mtime;   /* modification time the contents were read at */
+    long                    mtime_nsec;
+    unsigned int            count;   /* number of names */
+    unsigned int            mask;    /* hash buckets mask */
+    unsigned int           *buckets; /* hash buckets, indices into names, NULL if too many names */
+    struct dir_lookup_name *names;
+    WCHAR                  *wbuf;    /* Unicode names */
+    char                   *ubuf;    /* Unix names */
+};
+
+#define DIR_LOOKUP_CACHE_SIZE 8
+#define DIR_LOOKUP_MAX_NAMES  65536
+
+static struct dir_lookup_cache *dir_lookup_cache[DIR_LOOKUP_CACHE_SIZE];
+static unsigned int dir_lookup_cache_next;
+static pthread_mutex_t dir_lookup_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static unsigned int hash_dir_lookup_name( const WCHAR *name, int length )
+{
+    unsigned int hash = 0;
+    int i;
+
+    for (i = 0; i < length; i++) hash = hash * 31 + towupper( name[i] );
+    return hash;
+}
+
+static long get_stat_mtime_nsec( const struct stat *st )
+{
+#ifdef HAVE_STRUCT_STAT_ST_MTIM
+    return st->st_mtim.tv_nsec;
+#elif defined(HAVE_STRUCT_STAT_ST_MTIMESPEC)
+    return st->st_mtimespec.tv_nsec;
+#else
+    return 0;
+#endif
+}
+
+static void free_dir_lookup_cache( struct dir_lookup_cache *cache )
+{
+    if (!cache) return;
+    free( cache->buckets );
+    free( cache->names );
+    free( cache->wbuf );
+    free( cache->ubuf );
+    free( cache );
+}
+
+/***********************************************************************
+ *           read_dir_lookup_cache
+ *
+ * Read the contents of a directory into a new lookup cache entry.
+ * Directories with too many names get an entry without any names, so that
+ * they are only read once until they are modified.
+ */
+static struct dir_lookup_cache *read_dir_lookup_cache( const char *unix_name, const struct stat *st )
+{
+    struct dir_lookup_cache *cache;
+    WCHAR buffer[MAX_DIR_ENTRY_LEN];
+    unsigned int names_size = 64, wbuf_size = 1024, ubuf_size = 1024, wpos = 0, upos = 0, i;
+    struct dirent *de;
+    DIR *dir;
+    int len, ulen;
+
+    if (!(dir = opendir( unix_name ))) return NULL;
+    if (!(cache = calloc( 1, sizeof(*cache) ))) goto failed;
+    cache->dev = st->st_dev;
+    cache->ino = st->st_ino;
+    cache->mtime = st->st_mtime;
+    cache->mtime_nsec = get_stat_mtime_nsec( st );
+    if (!(cache->names = malloc( names_size * sizeof(*cache->names) ))) goto failed;
+    if (!(cache->wbuf = malloc( wbuf_size * sizeof(WCHAR) ))) goto failed;
+    if (!(cache->ubuf = malloc( ubuf_size ))) goto failed;
+
+    while ((de = readdir( dir )))
+    {
+        if ((len = ntdll_umbstowcs( de->d_name, strlen(de->d_name), buffer, MAX_DIR_ENTRY_LEN )) < 0)
+            continue;
+        ulen = strlen( de->d_name ) + 1;
+        if (cache->count == DIR_LOOKUP_MAX_NAMES) goto too_large;
+        if (cache->count == names_size)
+        {
+            struct dir_lookup_name *names = realloc( cache->names, names_size * 2 * sizeof(*names) );
+            if (!names) goto failed;
+            cache->names = names;
+            names_size *= 2;
+        }
+        while (wpos + len > wbuf_size)
+        {
+            WCHAR *wbuf = realloc( cache->wbuf, wbuf_size * 2 * sizeof(WCHAR) );
+            if (!wbuf) goto failed;
+            cache->wbuf = wbuf;
+            wbuf_size *= 2;
+        }
+        while (upos + ulen > ubuf_size)
+        {
+            char *ubuf = realloc( cache->ubuf, ubuf_size * 2 );
+            if (!ubuf) goto failed;
+            cache->ubuf = ubuf;
+            ubuf_size *= 2;
+        }
+        cache->names[cache->count].hash = hash_dir_lookup_name( buffer, len );
+        cache->names[cache->count].len = len;
+        cache->names[cache->count].name = wpos;
+        cache->names[cache->count].unix_name = upos;
+        memcpy( cache->wbuf + wpos, buffer, len * sizeof(WCHAR) );
+        memcpy( cache->ubuf + upos, de->d_name, ulen );
+        wpos += len;
+        upos += ulen;
+        cache->count++;
+    }
+    closedir( dir );
+
+    for (cache->mask = 15; cache->mask < cache->count; cache->mask = cache->mask * 2 + 1) ;
+    if (!(cache->buckets = malloc( (cache->mask + 1) * sizeof(*cache->buckets) )))
+    {
+        free_dir_lookup_cache( cache );
+        return NULL;
+    }
+    memset( cache->buckets, 0xff, (cache->mask + 1) * sizeof(*cache->buckets) );
+    /* insert in reverse order so that lookups return the first match in readdir order */
+    for (i = cache->count; i--; )
+    {
+        unsigned int *bucket = &cache->buckets[cache->names[i].hash & cache->mask];
+        cache->names[i].next = *bucket;
+        *bucket = i;
+    }
+    return cache;
+
+too_large:
+    closedir( dir );
+    free( cache->names );
+    free( cache->wbuf );
+    free( cache->ubuf );
+    cache->names = NULL;
+    cache->wbuf = NULL;
+    cache->ubuf = NULL;
+    cache->count = 0;
+    return cache;
+
+failed:
+    closedir( dir );
+    free_dir_lookup_cache( cache );
+    return NULL;
+}
+
+/***********************************************************************
+ *           lookup_dir_cache
+ *
+ * Look for a file name in the cached contents of the directory unix_name.
+ * On success the Unix name of the file is copied to found.
+ * Returns STATUS_NOT_SUPPORTED if the directory contents can't be cached.
+ */
+static NTSTATUS lookup_dir_cache( const char *unix_name, const WCHAR *name, int length, char *found )
+{
+    struct dir_lookup_cache *cache = NULL;
+    unsigned int i, hash = hash_dir_lookup_name( name, length );
+    NTSTATUS status = STATUS_OBJECT_NAME_NOT_FOUND;
+    struct stat st;
+
+    if (stat( unix_name, &st ) == -1) return errno_to_status( errno );
+
+    /* the modification time only invalidates the cache reliably once it's in the past,
+     * since changes made within the same clock tick can leave it untouched */
+    if (st.st_mtime >= time( NULL ) - 1) return STATUS_NOT_SUPPORTED;
+
+    mutex_lock( &dir_lookup_mutex );
+    for (i = 0; i < DIR_LOOKUP_CACHE_SIZE; i++)
+    {
+        struct dir_lookup_cache *entry = dir_lookup_cache[i];
+        if (!entry || entry->dev != st.st_dev || entry->ino != st.st_ino) continue;
+        if (entry->mtime == st.st_mtime && entry->mtime_nsec == get_stat_mtime_nsec( &st ))
+            cache = entry;
+        else
+        {
+            free_dir_lookup_cache( entry );
+            dir_lookup_cache[i] = NULL;
+        }
+        break;
+    }
+    if (!cache)
+    {
+        if (!(cache = read_dir_lookup_cache( unix_name, &st )))
+        {
+            mutex_unlock( &dir_lookup_mutex );
+            return STATUS_NOT_SUPPORTED;
+        }
+        i = dir_lookup_cache_next++ % DIR_LOOKUP_CACHE_SIZE;
+        free_dir_lookup_cache( dir_lookup_cache[i] );
+        dir_lookup_cache[i] = cache;
+    }
+
+    if (!cache->buckets)
+    {
+        mutex_unlock( &dir_lookup_mutex );
+        return STATUS_NOT_SUPPORTED;
+    }
+
+    for (i = cache->buckets[hash & cache->mask]; i != ~0u; i = cache->names[i].next)
+    {
+        const struct dir_lookup_name *entry = &cache->names[i];
+        if (entry->hash != hash || entry->len != length) continue;
+        if (wcsnicmp( cache->wbuf + entry->name, name, length )) continue;
+        strcpy( found, cache->ubuf + entry->unix_name );
+        status = STATUS_SUCCESS;
+        break;
+    }
+    mutex_unlock( &dir_lookup_mutex );
+    return status;
+}
+
+
 /***********************************************************************
  *           find_file_in_dir
  *
@@ -3004,6 +3255,19 @@ static NTSTATUS find_file_in_dir( char *unix_name, int pos, const WCHAR *name, i
     }
 #endif /* VFAT_IOCTL_READDIR_BOTH */
 
+    switch (lookup_dir_cache( unix_name, name, length, unix_name + pos ))
+    {
+    case STATUS_SUCCESS:
+        unix_name[pos - 1] = '/';
+        return STATUS_SUCCESS;
+    case STATUS_OBJECT_NAME_NOT_FOUND:
+        /* short names are not cached, fall back to a full scan for them */
+        if (!is_name_8_dot_3) goto not_found;
+        break;
+    default:
+        break;
+    }
+
     if (!(dir = opendir( unix_name ))) return errno_to_status( errno );
 
     unix_name[pos - 1] = '/';
@@ -7212,6 +7476,84 @@ static void ignore_server_ioctl_struct_holes( ULONG code, const void *in_buffer,
 }
 
 
+#ifdef __linux__
+#ifndef FICLONERANGE
+struct file_clone_range
+{
+    int64_t  src_fd;
+    uint64_t src_offset;
+    uint64_t src_length;
+    uint64_t dest_offset;
+};
+#define FICLONERANGE _IOW( 0x94, 13, struct file_clone_range )
+#endif
+#endif
+
+/***********************************************************************
+ *           duplicate_extents
+ *
+ * Implementation of FSCTL_DUPLICATE_EXTENTS_TO_FILE. Shares the data blocks of
+ * the source file if the file system supports it, and otherwise lets the kernel
+ * copy the data without going through user space.
+ */
+static NTSTATUS duplicate_extents( HANDLE handle, const DUPLICATE_EXTENTS_DATA *data, ULONG size )
+{
+    NTSTATUS status;
+    int dst_fd, src_fd, dst_needs_close, src_needs_close;
+
+    if (!data || size < sizeof(*data)) return STATUS_INVALID_PARAMETER;
+    if (data->SourceFileOffset.QuadPart < 0 || data->TargetFileOffset.QuadPart < 0 ||
+        data->ByteCount.QuadPart < 0)
+        return STATUS_INVALID_PARAMETER;
+    if (!data->ByteCount.QuadPart) return STATUS_SUCCESS;
+
+    if ((status = server_get_unix_fd( handle, FILE_WRITE_DATA, &dst_fd, &dst_needs_close, NULL, NULL )))
+        return status;
+    if ((status = server_get_unix_fd( data->FileHandle, FILE_READ_DATA, &src_fd, &src_needs_close, NULL, NULL )))
+    {
+        if (dst_needs_close) close( dst_fd );
+        return status;
+    }
+
+    status = STATUS_NOT_SUPPORTED;
+#ifdef __linux__
+    {
+        struct file_clone_range range;
+
+        range.src_fd = src_fd;
+        range.src_offset = data->SourceFileOffset.QuadPart;
+        range.src_length = data->ByteCount.QuadPart;
+        range.dest_offset = data->TargetFileOffset.QuadPart;
+        if (!ioctl( dst_fd, FICLONERANGE, &range )) status = STATUS_SUCCESS;
+    }
+#ifdef __NR_copy_file_range
+    if (status)
+    {
+        int64_t src_pos = data->SourceFileOffset.QuadPart, dst_pos = data->TargetFileOffset.QuadPart;
+        ULONGLONG count = data->ByteCount.QuadPart;
+        ssize_t ret = 0;
+
+        while (count)
+        {
+            ret = syscall( __NR_copy_file_range, src_fd, &src_pos, dst_fd, &dst_pos,
+                           min( count, 0x40000000 ), 0 );
+            if (ret <= 0) break;
+            count -= ret;
+        }
+        if (!count) status = STATUS_SUCCESS;
+        else if (!ret) status = STATUS_END_OF_FILE;
+        /* if nothing was copied, the caller can still fall back to copying the data itself */
+        else if (dst_pos != data->TargetFileOffset.QuadPart) status = errno_to_status( errno );
+    }
+#endif
+#endif
+
+    if (dst_needs_close) close( dst_fd );
+    if (src_needs_close) close( src_fd );
+    return status;
+}
+
+
 /******************************************************************************
  *              NtFsControlFile   (NTDLL.@)
  */
@@ -7316,6 +7658,11 @@ NTSTATUS WINAPI NtFsControlFile( HANDLE handle, HANDLE event, PIO_APC_ROUTINE ap
         break;
     }
 
+    case FSCTL_DUPLICATE_EXTENTS_TO_FILE:
+        status = duplicate_extents( handle, in_buffer, in_size );
+        io->Information = 0;
+        break;
+
     case FSCTL_SET_SPARSE:
         TRACE("FSCTL_SET_SPARSE: Ignoring request\n");
         io->Information = 0;
@@ -440,7 +440,14 @@ static NTSTATUS spawn_process( const RTL_USER_PROCESS_PARAMETERS *params, int so
 
     if (!(pid = fork()))  /* child */
     {
-        if (!(pid = fork()))  /* grandchild */
+#ifdef __linux__
+        /* the child exits right away, so the grandchild can borrow its address space
+         * instead of copying the page tables of the whole process a second time */
+        pid = vfork();
+#else
+        pid = fork();
+#endif
+        if (!pid)  /* grandchild */
         {
             if ((peb->ProcessParameters && params->ProcessGroupId != peb->ProcessParameters->ProcessGroupId) ||
                 params->ConsoleHandle == CONSOLE_HANDLE_ALLOC ||
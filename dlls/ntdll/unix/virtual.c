@@ -33,6 +33,7 @@
 #include <stdlib.h>
 #include <signal.h>
 #include <sys/types.h>
+#include <sys/ioctl.h>
 #include <sys/socket.h>
 #include <sys/stat.h>
 #include <sys/mman.h>
@@ -56,6 +57,12 @@
 #endif
 #include <unistd.h>
 #include <dlfcn.h>
+#ifdef HAVE_SYS_SYSCALL_H
+# include <sys/syscall.h>
+#endif
+#ifdef HAVE_LINUX_USERFAULTFD_H
+# include <linux/userfaultfd.h>
+#endif
 #ifdef HAVE_VALGRIND_VALGRIND_H
 # include <valgrind/valgrind.h>
 #endif
@@ -154,6 +161,7 @@ static const BYTE VIRTUAL_Win32Flags[16] =
 };
 
 static struct wine_rb_tree views_tree;
+static struct file_view *last_view;  /* last view returned by find_view */
 static pthread_mutex_t virtual_mutex;
 
 static const UINT page_shift = 12;
@@ -220,6 +228,52 @@ static void *preload_reserve_start;
 static void *preload_reserve_end;
 static BOOL force_exec_prot;  /* whether to force PROT_EXEC on all PROT_READ mmaps */
 
+#if defined(HAVE_LINUX_USERFAULTFD_H) && defined(UFFDIO_WRITEPROTECT) && defined(__NR_userfaultfd)
+
+#define HAVE_KERNEL_WRITEWATCH
+
+/* definitions from newer kernel headers for write watches through async userfaultfd and pagemap */
+#ifndef UFFD_FEATURE_WP_UNPOPULATED
+#define UFFD_FEATURE_WP_UNPOPULATED (1 << 13)
+#endif
+#ifndef UFFD_FEATURE_WP_ASYNC
+#define UFFD_FEATURE_WP_ASYNC (1 << 15)
+#endif
+#ifndef PAGEMAP_SCAN
+#define PAGE_IS_WRITTEN (1 << 1)
+#define PM_SCAN_WP_MATCHING (1 << 0)
+#define PM_SCAN_CHECK_WPASYNC (1 << 1)
+struct page_region
+{
+    __u64 start;
+    __u64 end;
+    __u64 categories;
+};
+struct pm_scan_arg
+{
+    __u64 size;
+    __u64 flags;
+    __u64 start;
+    __u64 end;
+    __u64 walk_end;
+    __u64 vec;
+    __u64 vec_len;
+    __u64 max_pages;
+    __u64 category_inverted;
+    __u64 category_mask;
+    __u64 category_anyof_mask;
+    __u64 return_mask;
+};
+#define PAGEMAP_SCAN _IOWR('f', 16, struct pm_scan_arg)
+#endif
+
+static int uffd_fd = -1;     /* userfaultfd used to write-protect write watch ranges */
+static int pagemap_fd = -1;  /* /proc/self/pagemap used to query and reset write watches */
+
+#endif  /* HAVE_LINUX_USERFAULTFD_H */
+
+static BOOL use_kernel_writewatch;  /* whether write watches are tracked by the kernel */
+
 struct range_entry
 {
     void *base;
@@ -1227,17 +1281,25 @@ static void VIRTUAL_Dump(void)
 static struct file_view *find_view( const void *addr, size_t size )
 {
     struct wine_rb_entry *ptr = views_tree.root;
+    struct file_view *view;
 
     if ((const char *)addr + size < (const char *)addr) return NULL; /* overflow */
 
+    /* repeated operations on the same view are common, check the last one first */
+    if ((view = last_view) && view->base <= addr && (const char *)view->base + view->size > (const char *)addr)
+    {
+        if ((const char *)view->base + view->size < (const char *)addr + size) return NULL;  /* size too large */
+        return view;
+    }
+
     while (ptr)
     {
-        struct file_view *view = WINE_RB_ENTRY_VALUE( ptr, struct file_view, entry );
+        view = WINE_RB_ENTRY_VALUE( ptr, struct file_view, entry );
 
         if (view->base > addr) ptr = ptr->left;
         else if ((const char *)view->base + view->size <= (const char *)addr) ptr = ptr->right;
         else if ((const char *)view->base + view->size < (const char *)addr + size) break;  /* size too large */
-        else return view;
+        else return last_view = view;
     }
     return NULL;
 }
@@ -1439,6 +1501,7 @@ static void free_view( struct file_view *view )
  */
 static void unregister_view( struct file_view *view )
 {
+    if (last_view == view) last_view = NULL;
     free_ranges_remove_view( view );
     wine_rb_remove( &views_tree, &view->entry );
 }
@@ -1710,6 +1773,150 @@ static void commit_arm64ec_map( struct file_view *view )
 }
 
 
+#ifdef HAVE_KERNEL_WRITEWATCH
+
+/***********************************************************************
+ *           kernel_writewatch_init
+ *
+ * Check whether the kernel supports asynchronous userfaultfd write protection
+ * and pagemap scanning, which lets it track write watches without faulting
+ * into our signal handler on every first write to a page.
+ */
+static void kernel_writewatch_init(void)
+{
+    struct uffdio_api api = { .api = UFFD_API, .features = UFFD_FEATURE_WP_ASYNC | UFFD_FEATURE_WP_UNPOPULATED };
+    struct pm_scan_arg arg = { .size = sizeof(arg) };
+    const char *env = getenv( "WINE_DISABLE_KERNEL_WRITEWATCH" );
+
+    if (env && atoi( env )) return;
+
+    if ((uffd_fd = syscall( __NR_userfaultfd, O_CLOEXEC | O_NONBLOCK | UFFD_USER_MODE_ONLY )) == -1)
+        return;
+    if (ioctl( uffd_fd, UFFDIO_API, &api ) == -1 ||
+        (api.features & (UFFD_FEATURE_WP_ASYNC | UFFD_FEATURE_WP_UNPOPULATED)) !=
+        (UFFD_FEATURE_WP_ASYNC | UFFD_FEATURE_WP_UNPOPULATED))
+        goto failed;
+    if ((pagemap_fd = open( "/proc/self/pagemap", O_RDONLY | O_CLOEXEC )) == -1) goto failed;
+    /* an empty scan fails with ENOTTY if PAGEMAP_SCAN isn't supported */
+    if (ioctl( pagemap_fd, PAGEMAP_SCAN, &arg ) == -1) goto failed;
+
+    TRACE( "using kernel write watches\n" );
+    use_kernel_writewatch = TRUE;
+    return;
+
+failed:
+    close( uffd_fd );
+    uffd_fd = -1;
+    if (pagemap_fd != -1) close( pagemap_fd );
+    pagemap_fd = -1;
+}
+
+
+/***********************************************************************
+ *           kernel_writewatch_reset
+ */
+static BOOL kernel_writewatch_reset( void *base, SIZE_T size )
+{
+    struct uffdio_writeprotect wp;
+
+    wp.range.start = (ULONG_PTR)base;
+    wp.range.len = size;
+    wp.mode = UFFDIO_WRITEPROTECT_MODE_WP;
+    if (ioctl( uffd_fd, UFFDIO_WRITEPROTECT, &wp ) == -1)
+    {
+        ERR( "failed to reset write watches %p-%p, errno %d\n", base, (char *)base + size, errno );
+        return FALSE;
+    }
+    return TRUE;
+}
+
+
+/***********************************************************************
+ *           kernel_writewatch_register
+ *
+ * Register a range for write protection. Needs to be done again whenever the range is remapped.
+ */
+static BOOL kernel_writewatch_register( void *base, SIZE_T size )
+{
+    struct uffdio_register reg;
+
+    reg.range.start = (ULONG_PTR)base;
+    reg.range.len = size;
+    reg.mode = UFFDIO_REGISTER_MODE_WP;
+    if (ioctl( uffd_fd, UFFDIO_REGISTER, &reg ) == -1)
+    {
+        ERR( "failed to register write watches %p-%p, errno %d\n", base, (char *)base + size, errno );
+        return FALSE;
+    }
+    return kernel_writewatch_reset( base, size );
+}
+
+
+/***********************************************************************
+ *           kernel_get_write_watches
+ *
+ * Retrieve the written pages in a range, optionally resetting the watches on them.
+ */
+static BOOL kernel_get_write_watches( void *base, SIZE_T size, void **addresses, ULONG_PTR *count, BOOL reset )
+{
+    struct page_region regions[64];
+    struct pm_scan_arg arg = { .size = sizeof(arg) };
+    ULONG_PTR pos = 0;
+    char *addr = base, *end = addr + size;
+    int i, ret;
+
+    arg.flags = PM_SCAN_CHECK_WPASYNC | (reset ? PM_SCAN_WP_MATCHING : 0);
+    arg.vec = (ULONG_PTR)regions;
+    arg.vec_len = ARRAY_SIZE(regions);
+    arg.category_mask = PAGE_IS_WRITTEN;
+    arg.return_mask = PAGE_IS_WRITTEN;
+
+    while (pos < *count && addr < end)
+    {
+        arg.start = (ULONG_PTR)addr;
+        arg.end = (ULONG_PTR)end;
+        arg.max_pages = *count - pos;
+        if ((ret = ioctl( pagemap_fd, PAGEMAP_SCAN, &arg )) == -1)
+        {
+            ERR( "failed to get write watches %p-%p, errno %d\n", addr, end, errno );
+            return FALSE;
+        }
+        for (i = 0; i < ret; i++)
+        {
+            char *page = (char *)(ULONG_PTR)regions[i].start;
+            for ( ; page < (char *)(ULONG_PTR)regions[i].end && pos < *count; page += page_size)
+                addresses[pos++] = page;
+        }
+        addr = (char *)(ULONG_PTR)arg.walk_end;
+    }
+    *count = pos;
+    return TRUE;
+}
+
+#else  /* HAVE_KERNEL_WRITEWATCH */
+
+static void kernel_writewatch_init(void)
+{
+}
+
+static BOOL kernel_writewatch_reset( void *base, SIZE_T size )
+{
+    return FALSE;
+}
+
+static BOOL kernel_writewatch_register( void *base, SIZE_T size )
+{
+    return FALSE;
+}
+
+static BOOL kernel_get_write_watches( void *base, SIZE_T size, void **addresses, ULONG_PTR *count, BOOL reset )
+{
+    return FALSE;
+}
+
+#endif  /* HAVE_KERNEL_WRITEWATCH */
+
+
 /***********************************************************************
  *           update_write_watches
  */
@@ -1730,11 +1937,52 @@ static void update_write_watches( void *base, size_t size, size_t accessed_size
  */
 static void reset_write_watches( void *base, SIZE_T size )
 {
+    if (use_kernel_writewatch)
+    {
+        kernel_writewatch_reset( base, size );
+        return;
+    }
     set_page_vprot_bits( base, size, VPROT_WRITEWATCH, 0 );
     mprotect_range( base, size, 0, 0 );
 }
 
 
+/***********************************************************************
+ *           disable_kernel_writewatch
+ *
+ * Switch back to tracking write watches through page protections. Pages of ranges
+ * tracked by the kernel so far have no watch bits set, so they are reported as
+ * written until the next reset, which never misses a write.
+ */
+static void disable_kernel_writewatch(void)
+{
+    ERR( "kernel write watches failed, falling back to page protections\n" );
+    use_kernel_writewatch = FALSE;
+}
+
+
+/***********************************************************************
+ *           init_write_watches
+ *
+ * Start tracking writes in a newly allocated or remapped write watch range.
+ */
+static void init_write_watches( void *base, SIZE_T size )
+{
+    if (use_kernel_writewatch)
+    {
+        if (kernel_writewatch_register( base, size ))
+        {
+            /* the pages don't need to be write-protected by us, the kernel tracks them */
+            set_page_vprot_bits( base, size, 0, VPROT_WRITEWATCH );
+            mprotect_range( base, size, 0, 0 );
+            return;
+        }
+        disable_kernel_writewatch();
+    }
+    reset_write_watches( base, size );
+}
+
+
 /***********************************************************************
  *           unmap_extra_space
  *
@@ -2064,7 +2312,7 @@ static NTSTATUS map_view( struct file_view **view_ret, void *base, size_t size,
 
         view->protect = vprot | VPROT_PLACEHOLDER;
         set_vprot( view, base, size, vprot );
-        if (vprot & VPROT_WRITEWATCH) reset_write_watches( base, size );
+        if (vprot & VPROT_WRITEWATCH) init_write_watches( base, size );
         *view_ret = view;
         return STATUS_SUCCESS;
     }
@@ -2100,6 +2348,7 @@ static NTSTATUS map_view( struct file_view **view_ret, void *base, size_t size,
     }
     status = create_view( view_ret, ptr, size, vprot );
     if (status != STATUS_SUCCESS) unmap_area( ptr, size );
+    else if (use_kernel_writewatch && (vprot & VPROT_WRITEWATCH)) init_write_watches( ptr, size );
     return status;
 }
 
@@ -2234,6 +2483,9 @@ static NTSTATUS decommit_pages( struct file_view *view, size_t start, size_t siz
     if (anon_mmap_fixed( (char *)view->base + start, size, PROT_NONE, 0 ) != MAP_FAILED)
     {
         set_page_vprot_bits( (char *)view->base + start, size, 0, VPROT_COMMITTED );
+        /* the new mapping isn't registered for write protection anymore */
+        if (use_kernel_writewatch && (view->protect & VPROT_WRITEWATCH))
+            init_write_watches( (char *)view->base + start, size );
         return STATUS_SUCCESS;
     }
     return STATUS_NO_MEMORY;
@@ -2739,6 +2991,35 @@ static IMAGE_BASE_RELOCATION *process_relocation_block( char *page, IMAGE_BASE_R
 }
 
 
+/***********************************************************************
+ *           is_relocated_by_server
+ *
+ * Check if a relocation block applies to a read-only section that has been relocated by the
+ * server. This must match the sections selected in build_relocated_mapping().
+ */
+static BOOL is_relocated_by_server( const IMAGE_SECTION_HEADER *sec, unsigned int count, DWORD va )
+{
+    static const SIZE_T sector_align = 0x1ff;
+    SIZE_T map_size, file_size;
+    unsigned int i;
+
+    for (i = 0; i < count; i++)
+    {
+        if (sec[i].Characteristics & IMAGE_SCN_MEM_WRITE) continue;
+        if (!sec[i].PointerToRawData) continue;
+        if (va < sec[i].VirtualAddress) continue;
+
+        if (!sec[i].Misc.VirtualSize) map_size = ROUND_SIZE( 0, sec[i].SizeOfRawData );
+        else map_size = ROUND_SIZE( 0, sec[i].Misc.VirtualSize );
+        file_size = (sec[i].SizeOfRawData + (sec[i].PointerToRawData & sector_align) + sector_align) & ~sector_align;
+        if (file_size > map_size) file_size = map_size;
+
+        if (va - sec[i].VirtualAddress < file_size) return TRUE;
+    }
+    return FALSE;
+}
+
+
 /***********************************************************************
  *           map_image_into_view
  *
@@ -2747,7 +3028,7 @@ static IMAGE_BASE_RELOCATION *process_relocation_block( char *page, IMAGE_BASE_R
  */
 static NTSTATUS map_image_into_view( struct file_view *view, const WCHAR *filename, int fd,
                                      pe_image_info_t *image_info, USHORT machine,
-                                     int shared_fd, BOOL removable )
+                                     int shared_fd, int reloc_fd, BOOL removable )
 {
     IMAGE_DOS_HEADER *dos;
     IMAGE_NT_HEADERS *nt;
@@ -2818,7 +3099,9 @@ static NTSTATUS map_image_into_view( struct file_view *view, const WCHAR *filena
     for (i = pos = 0; i < nt->FileHeader.NumberOfSections; i++, sec++)
     {
         static const SIZE_T sector_align = 0x1ff;
-        SIZE_T map_size, file_start, file_size, end;
+        SIZE_T map_size, file_start, file_size, end, map_start;
+        BOOL map_removable;
+        int map_fd;
 
         if (!sec->Misc.VirtualSize)
             map_size = ROUND_SIZE( 0, sec->SizeOfRawData );
@@ -2876,6 +3159,20 @@ static NTSTATUS map_image_into_view( struct file_view *view, const WCHAR *filena
 
         if (!sec->PointerToRawData || !file_size) continue;
 
+        /* read-only sections relocated to the dynamic base by the server are shared between processes */
+        if (reloc_fd != -1 && !(sec->Characteristics & IMAGE_SCN_MEM_WRITE))
+        {
+            map_fd = reloc_fd;
+            map_start = sec->VirtualAddress;
+            map_removable = FALSE;
+        }
+        else
+        {
+            map_fd = fd;
+            map_start = file_start;
+            map_removable = removable;
+        }
+
         /* Note: if the section is not aligned properly map_file_into_view will magically
          *       fall back to read(), so we don't need to check anything here.
          */
@@ -2883,9 +3180,9 @@ static NTSTATUS map_image_into_view( struct file_view *view, const WCHAR *filena
         if (sec->PointerToRawData >= st.st_size ||
             end > ((st.st_size + sector_align) & ~sector_align) ||
             end < file_start ||
-            map_file_into_view( view, fd, sec->VirtualAddress, file_size, file_start,
+            map_file_into_view( view, map_fd, sec->VirtualAddress, file_size, map_start,
                                 VPROT_COMMITTED | VPROT_READ | VPROT_WRITECOPY,
-                                removable ) != STATUS_SUCCESS)
+                                map_removable ) != STATUS_SUCCESS)
         {
             ERR_(module)( "Could not map %s section %.8s, file probably truncated\n",
                           debugstr_w(filename), sec->Name );
@@ -2940,7 +3237,13 @@ static NTSTATUS map_image_into_view( struct file_view *view, const WCHAR *filena
             IMAGE_BASE_RELOCATION *end = (IMAGE_BASE_RELOCATION *)((char *)rel + dir->Size);
 
             while (rel && rel < end - 1 && rel->SizeOfBlock && rel->VirtualAddress < total_size)
-                rel = process_relocation_block( ptr + rel->VirtualAddress, rel, delta );
+            {
+                if (reloc_fd != -1 && is_relocated_by_server( sections, nt->FileHeader.NumberOfSections,
+                                                              rel->VirtualAddress ))
+                    rel = (IMAGE_BASE_RELOCATION *)((char *)rel + rel->SizeOfBlock);
+                else
+                    rel = process_relocation_block( ptr + rel->VirtualAddress, rel, delta );
+            }
         }
     }
 
@@ -3095,6 +3398,8 @@ static NTSTATUS virtual_map_image( HANDLE mapping, void **addr_ptr, SIZE_T *size
 {
     int unix_fd = -1, needs_close;
     int shared_fd = -1, shared_needs_close = 0;
+    int reloc_fd = -1, reloc_needs_close = 0;
+    HANDLE reloc_file = 0;
     SIZE_T size = image_info->map_size;
     struct file_view *view;
     unsigned int status;
@@ -3110,24 +3415,31 @@ static NTSTATUS virtual_map_image( HANDLE mapping, void **addr_ptr, SIZE_T *size
         return status;
     }
 
-    if (!image_info->map_addr &&
-        (image_info->image_charact & IMAGE_FILE_DLL) &&
+    if ((image_info->image_charact & IMAGE_FILE_DLL) &&
         (image_info->image_flags & IMAGE_FLAGS_ImageDynamicallyRelocated))
     {
         SERVER_START_REQ( get_image_map_address )
         {
             req->handle = wine_server_obj_handle( mapping );
-            if (!wine_server_call( req )) image_info->map_addr = reply->addr;
+            if (!wine_server_call( req ))
+            {
+                image_info->map_addr = reply->addr;
+                reloc_file = wine_server_ptr_handle( reply->reloc_file );
+            }
         }
         SERVER_END_REQ;
     }
 
+    if (reloc_file &&
+        server_get_unix_fd( reloc_file, FILE_READ_DATA, &reloc_fd, &reloc_needs_close, NULL, NULL ))
+        reloc_fd = -1;
+
     server_enter_uninterrupted_section( &virtual_mutex, &sigset );
 
     status = map_image_view( &view, image_info, size, limit_low, limit_high, alloc_type );
     if (status) goto done;
 
-    status = map_image_into_view( view, filename, unix_fd, image_info, machine, shared_fd, needs_close );
+    status = map_image_into_view( view, filename, unix_fd, image_info, machine, shared_fd, reloc_fd, needs_close );
     if (status == STATUS_SUCCESS)
     {
         SERVER_START_REQ( map_image_view )
@@ -3154,6 +3466,8 @@ done:
     server_leave_uninterrupted_section( &virtual_mutex, &sigset );
     if (needs_close) close( unix_fd );
     if (shared_needs_close) close( shared_fd );
+    if (reloc_needs_close) close( reloc_fd );
+    if (reloc_file) NtClose( reloc_file );
     return status;
 }
 
@@ -3385,6 +3699,8 @@ void virtual_init(void)
     size = (char *)address_space_start - (char *)0x10000;
     if (size && mmap_is_in_reserved_area( (void*)0x10000, size ) == 1)
         anon_mmap_fixed( (void *)0x10000, size, PROT_READ | PROT_WRITE, 0 );
+
+    kernel_writewatch_init();
 }
 
 
@@ -6017,12 +6333,20 @@ NTSTATUS WINAPI NtGetWriteWatch( HANDLE process, ULONG flags, PVOID base, SIZE_T
 
     server_enter_uninterrupted_section( &virtual_mutex, &sigset );
 
-    if (is_write_watch_range( base, size ))
+    if (!is_write_watch_range( base, size )) status = STATUS_INVALID_PARAMETER;
+    else if (use_kernel_writewatch &&
+             kernel_get_write_watches( base, size, addresses, count, flags & WRITE_WATCH_FLAG_RESET ))
+    {
+        *granularity = page_size;
+    }
+    else
     {
         ULONG_PTR pos = 0;
         char *addr = base;
         char *end = addr + size;
 
+        if (use_kernel_writewatch) disable_kernel_writewatch();
+
         while (pos < *count && addr < end)
         {
             if (!(get_page_vprot( addr ) & VPROT_WRITEWATCH)) addresses[pos++] = addr;
@@ -6032,7 +6356,6 @@ NTSTATUS WINAPI NtGetWriteWatch( HANDLE process, ULONG flags, PVOID base, SIZE_T
         *count = pos;
         *granularity = page_size;
     }
-    else status = STATUS_INVALID_PARAMETER;
 
     server_leave_uninterrupted_section( &virtual_mutex, &sigset );
     return status;
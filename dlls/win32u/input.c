@@ -739,22 +739,37 @@ BOOL WINAPI NtUserSetCursorPos( INT x, INT y )
  */
 BOOL get_cursor_pos( POINT *pt )
 {
+    const desktop_shm_t *desktop_shm;
     BOOL ret;
     DWORD last_change;
     UINT dpi;
 
     if (!pt) return FALSE;
 
-    SERVER_START_REQ( set_cursor )
+    if ((desktop_shm = get_desktop_shm()))
     {
-        if ((ret = !wine_server_call( req )))
+        SHARED_READ_BEGIN( desktop_shm )
         {
-            pt->x = reply->new_x;
-            pt->y = reply->new_y;
-            last_change = reply->last_change;
+            pt->x = desktop_shm->cursor_x;
+            pt->y = desktop_shm->cursor_y;
+            last_change = desktop_shm->cursor_last_change;
         }
+        SHARED_READ_END( desktop_shm );
+        ret = TRUE;
+    }
+    else
+    {
+        SERVER_START_REQ( set_cursor )
+        {
+            if ((ret = !wine_server_call( req )))
+            {
+                pt->x = reply->new_x;
+                pt->y = reply->new_y;
+                last_change = reply->last_change;
+            }
+        }
+        SERVER_END_REQ;
     }
-    SERVER_END_REQ;
 
     /* query new position from graphics driver if we haven't updated recently */
     if (ret && NtGetTickCount() - last_change > 100) ret = user_driver->pGetCursorPos( pt );
@@ -810,6 +825,7 @@ static void check_for_events( UINT flags )
 SHORT WINAPI NtUserGetAsyncKeyState( INT key )
 {
     struct user_key_state_info *key_state_info = get_user_thread_info()->key_state;
+    const desktop_shm_t *desktop_shm;
     INT counter = global_key_state_counter;
     BYTE prev_key_state;
     SHORT ret;
@@ -830,6 +846,29 @@ SHORT WINAPI NtUserGetAsyncKeyState( INT key )
         get_user_thread_info()->key_state = key_state_info;
     }
 
+    if (key_state_info && (desktop_shm = get_desktop_shm()))
+    {
+        BYTE keystate[256];
+
+        SHARED_READ_BEGIN( desktop_shm )
+        {
+            memcpy( keystate, (const BYTE *)desktop_shm->keystate, sizeof(keystate) );
+        }
+        SHARED_READ_END( desktop_shm );
+
+        /* the server needs to clear the "pressed since last call" bit */
+        if (!(keystate[key] & 0x40))
+        {
+            /* refresh the key state cache the same way as the server call below */
+            if (key_state_info->state[key] != keystate[key])
+                counter = InterlockedIncrement( &global_key_state_counter );
+            memcpy( key_state_info->state, keystate, sizeof(keystate) );
+            key_state_info->time    = NtGetTickCount();
+            key_state_info->counter = counter;
+            return (keystate[key] & 0x80) ? 0x8000 : 0;
+        }
+    }
+
     ret = 0;
     SERVER_START_REQ( get_key_state )
     {
@@ -867,6 +906,7 @@ SHORT WINAPI NtUserGetAsyncKeyState( INT key )
  */
 DWORD WINAPI NtUserGetQueueStatus( UINT flags )
 {
+    const queue_shm_t *queue_shm;
     DWORD ret;
 
     if (flags & ~(QS_ALLINPUT | QS_ALLPOSTMESSAGE | QS_SMRESULT))
@@ -877,6 +917,21 @@ DWORD WINAPI NtUserGetQueueStatus( UINT flags )
 
     check_for_events( flags );
 
+    if ((queue_shm = get_queue_shm()))
+    {
+        UINT wake_bits, changed_bits;
+
+        SHARED_READ_BEGIN( queue_shm )
+        {
+            wake_bits = queue_shm->wake_bits;
+            changed_bits = queue_shm->changed_bits;
+        }
+        SHARED_READ_END( queue_shm );
+
+        /* nothing to clear, no need to ask the server */
+        if (!(changed_bits & flags)) return MAKELONG( 0, wake_bits & flags );
+    }
+
     SERVER_START_REQ( get_queue_status )
     {
         req->clear_bits = flags;
@@ -892,10 +947,21 @@ DWORD WINAPI NtUserGetQueueStatus( UINT flags )
  */
 DWORD get_input_state(void)
 {
+    const queue_shm_t *queue_shm;
     DWORD ret;
 
     check_for_events( QS_INPUT );
 
+    if ((queue_shm = get_queue_shm()))
+    {
+        SHARED_READ_BEGIN( queue_shm )
+        {
+            ret = queue_shm->wake_bits & (QS_KEY | QS_MOUSEBUTTON);
+        }
+        SHARED_READ_END( queue_shm );
+        return ret;
+    }
+
     SERVER_START_REQ( get_queue_status )
     {
         req->clear_bits = 0;
@@ -47,6 +47,7 @@ WINE_DECLARE_DEBUG_CHANNEL(relay);
 #define WM_NCMOUSELAST  (WM_NCMOUSEFIRST+(WM_MOUSELAST-WM_MOUSEFIRST))
 
 #define MAX_PACK_COUNT 4
+#define MAX_CACHED_MESSAGE_BUFFER 65536
 
 /* info about the message currently being received by the current thread */
 struct received_message_info
@@ -482,6 +483,39 @@ static inline void *get_buffer_space( void **buffer, size_t size, size_t *buffer
     return *buffer;
 }
 
+/* get a buffer for message data, reusing the buffer cached by the thread when possible */
+static void *alloc_message_buffer( size_t size, size_t *buffer_size )
+{
+    struct user_thread_info *thread_info = get_user_thread_info();
+    void *buffer = thread_info->msg_buffer;
+
+    if (buffer && thread_info->msg_buffer_size >= size)
+    {
+        thread_info->msg_buffer = NULL;
+        *buffer_size = thread_info->msg_buffer_size;
+        return buffer;
+    }
+    if (!(buffer = malloc( size ))) return NULL;
+    *buffer_size = size;
+    return buffer;
+}
+
+/* release a message data buffer, keeping the largest reasonably sized one cached for the thread */
+static void free_message_buffer( void *buffer, size_t buffer_size )
+{
+    struct user_thread_info *thread_info = get_user_thread_info();
+
+    if (buffer_size > MAX_CACHED_MESSAGE_BUFFER ||
+        (thread_info->msg_buffer && thread_info->msg_buffer_size >= buffer_size))
+    {
+        free( buffer );
+        return;
+    }
+    free( thread_info->msg_buffer );
+    thread_info->msg_buffer = buffer;
+    thread_info->msg_buffer_size = buffer_size;
+}
+
 /* check whether a combobox expects strings or ids in CB_ADDSTRING/CB_INSERTSTRING */
 static inline BOOL combobox_has_strings( HWND hwnd )
 {
@@ -2184,7 +2218,7 @@ static LRESULT call_window_proc( HWND hwnd, UINT msg, WPARAM wparam, LPARAM lpar
 {
     struct win_proc_params p, *params = &p;
     BOOL ansi = ansi_dst && type == MSG_ASCII;
-    size_t packed_size = 0, offset = sizeof(*params), reply_size;
+    size_t packed_size = 0, offset = sizeof(*params), reply_size, params_size = 0;
     LRESULT result = 0;
     CWPSTRUCT cwp;
     CWPRETSTRUCT cwpret;
@@ -2209,12 +2243,12 @@ static LRESULT call_window_proc( HWND hwnd, UINT msg, WPARAM wparam, LPARAM lpar
     if (packed_size)
     {
         offset = (offset + 15) & ~15;
-        if (!(params = malloc( offset + packed_size ))) return 0;
+        if (!(params = alloc_message_buffer( offset + packed_size, &params_size ))) return 0;
     }
 
     if (!init_window_call_params( params, hwnd, msg, wparam, lparam, ansi_dst, mapping ))
     {
-        if (params != &p) free( params );
+        if (params != &p) free_message_buffer( params, params_size );
         return 0;
     }
 
@@ -2223,7 +2257,7 @@ static LRESULT call_window_proc( HWND hwnd, UINT msg, WPARAM wparam, LPARAM lpar
         pack_user_message( (char *)params + offset, packed_size, msg, wparam, lparam, ansi );
 
     result = dispatch_win_proc_params( params, offset + packed_size, &ret_ptr, &ret_len );
-    if (params != &p) free( params );
+    if (params != &p) free_message_buffer( params, params_size );
 
     copy_user_result( ret_ptr, min( ret_len, reply_size ), result, msg, wparam, lparam, ansi );
 
@@ -2700,6 +2734,57 @@ static BOOL process_hardware_message( MSG *msg, UINT hw_id, const struct hardwar
     return ret;
 }
 
+/***********************************************************************
+ *           check_queue_bits
+ *
+ * Check the queue shared memory to find out whether get_message would
+ * return STATUS_PENDING without changing the queue state.
+ */
+static BOOL check_queue_bits( BOOL internal, UINT wake_mask, UINT changed_mask,
+                              UINT signal_bits, UINT clear_bits )
+{
+    const queue_shm_t *queue_shm;
+    UINT wake_bits, changed_bits, queue_wake_mask, queue_changed_mask;
+
+    if (!(queue_shm = get_queue_shm())) return FALSE;
+
+    SHARED_READ_BEGIN( queue_shm )
+    {
+        wake_bits = queue_shm->wake_bits;
+        changed_bits = queue_shm->changed_bits;
+        queue_wake_mask = queue_shm->wake_mask;
+        queue_changed_mask = queue_shm->changed_mask;
+    }
+    SHARED_READ_END( queue_shm );
+
+    /* internal requests leave the queue masks and bits unchanged */
+    if (internal) return !(wake_bits & signal_bits);
+
+    if (queue_wake_mask != wake_mask || queue_changed_mask != changed_mask) return FALSE;
+    if (changed_bits & (clear_bits | changed_mask)) return FALSE;
+    return !(wake_bits & (signal_bits | wake_mask));
+}
+
+/***********************************************************************
+ *           get_hooks_serial
+ *
+ * Get the serial number of the last change to the active hooks, or 0 if unknown.
+ */
+static UINT get_hooks_serial(void)
+{
+    const desktop_shm_t *desktop_shm;
+    UINT serial = 0;
+
+    if (!(desktop_shm = get_desktop_shm())) return 0;
+
+    SHARED_READ_BEGIN( desktop_shm )
+    {
+        serial = desktop_shm->hooks_serial;
+    }
+    SHARED_READ_END( desktop_shm );
+    return serial;
+}
+
 /***********************************************************************
  *           peek_message
  *
@@ -2716,57 +2801,95 @@ int peek_message( MSG *msg, const struct peek_message_filter *filter )
     INPUT_MESSAGE_SOURCE prev_source = thread_info->client_info.msg_source;
     struct received_message_info info;
     unsigned int hw_id = 0;  /* id of previous hardware message */
+    UINT wake_mask = filter->mask & (QS_SENDMESSAGE | QS_SMRESULT);
+    UINT signal_bits, clear_bits = 0;
     void *buffer;
-    size_t buffer_size = 1024;
+    size_t buffer_size;
 
-    if (!(buffer = malloc( buffer_size ))) return -1;
+    if (!(buffer = alloc_message_buffer( 1024, &buffer_size ))) return -1;
 
     if (!first && !last) last = ~0;
     if (hwnd == HWND_BROADCAST) hwnd = HWND_TOPMOST;
 
+    /* queue bits that would make the server return a message, or that it would clear */
+    if (filter->internal) signal_bits = QS_RAWINPUT;  /* driver messages */
+    else
+    {
+        if (!(signal_bits = flags >> 16)) signal_bits = QS_ALLINPUT;
+        if (signal_bits & QS_POSTMESSAGE)
+        {
+            clear_bits |= QS_POSTMESSAGE | QS_HOTKEY | QS_TIMER;
+            if (first == 0 && last == ~0U) clear_bits |= QS_ALLPOSTMESSAGE;
+        }
+        if (signal_bits & QS_INPUT) clear_bits |= QS_INPUT;
+        if (signal_bits & QS_PAINT) clear_bits |= QS_PAINT;
+        signal_bits |= QS_SENDMESSAGE | QS_RAWINPUT;
+    }
+
     for (;;)
     {
         NTSTATUS res;
-        size_t size = 0;
+        size_t size = 0, total = 0;
         const message_data_t *msg_data = buffer;
+        UINT hooks_serial = get_hooks_serial();
 
         thread_info->client_info.msg_source = prev_source;
 
-        SERVER_START_REQ( get_message )
+        /* skip the server call if the queue state tells us there is nothing to get and
+         * our active hooks are up to date; the server still needs to hear from us regularly
+         * to not consider the queue hung, and it signals the process idle event when asked
+         * for messages with a -1 window */
+        if (!hw_id && hwnd != (HWND)-1 &&
+            hooks_serial && hooks_serial == thread_info->hooks_serial &&
+            (filter->internal || NtGetTickCount() - thread_info->last_getmsg_time < 3000) &&
+            check_queue_bits( filter->internal, wake_mask, filter->mask, signal_bits, clear_bits ))
+        {
+            res = STATUS_PENDING;
+        }
+        else
         {
-            req->internal  = filter->internal;
-            req->flags     = flags;
-            req->get_win   = wine_server_user_handle( hwnd );
-            req->get_first = first;
-            req->get_last  = last;
-            req->hw_id     = hw_id;
-            req->wake_mask = filter->mask & (QS_SENDMESSAGE | QS_SMRESULT);
-            req->changed_mask = filter->mask;
-            wine_server_set_reply( req, buffer, buffer_size );
-            if (!(res = wine_server_call( req )))
+            SERVER_START_REQ( get_message )
             {
-                size = wine_server_reply_size( reply );
-                info.type        = reply->type;
-                info.msg.hwnd    = wine_server_ptr_handle( reply->win );
-                info.msg.message = reply->msg;
-                info.msg.wParam  = reply->wparam;
-                info.msg.lParam  = reply->lparam;
-                info.msg.time    = reply->time;
-                info.msg.pt.x    = reply->x;
-                info.msg.pt.y    = reply->y;
-                hw_id            = 0;
-                thread_info->active_hooks = reply->active_hooks;
+                req->internal  = filter->internal;
+                req->flags     = flags;
+                req->get_win   = wine_server_user_handle( hwnd );
+                req->get_first = first;
+                req->get_last  = last;
+                req->hw_id     = hw_id;
+                req->wake_mask = wake_mask;
+                req->changed_mask = filter->mask;
+                wine_server_set_reply( req, buffer, buffer_size );
+                if (!(res = wine_server_call( req )))
+                {
+                    size = wine_server_reply_size( reply );
+                    info.type        = reply->type;
+                    info.msg.hwnd    = wine_server_ptr_handle( reply->win );
+                    info.msg.message = reply->msg;
+                    info.msg.wParam  = reply->wparam;
+                    info.msg.lParam  = reply->lparam;
+                    info.msg.time    = reply->time;
+                    info.msg.pt.x    = reply->x;
+                    info.msg.pt.y    = reply->y;
+                    hw_id            = 0;
+                }
+                else total = reply->total;
+                if (!res || res == STATUS_PENDING)
+                {
+                    thread_info->active_hooks = reply->active_hooks;
+                    thread_info->hooks_serial = hooks_serial;
+                }
             }
-            else buffer_size = reply->total;
+            SERVER_END_REQ;
+
+            if (!filter->internal) thread_info->last_getmsg_time = NtGetTickCount();
         }
-        SERVER_END_REQ;
 
         if (res)
         {
-            free( buffer );
+            free_message_buffer( buffer, buffer_size );
             if (res == STATUS_PENDING)
             {
-                thread_info->wake_mask = filter->mask & (QS_SENDMESSAGE | QS_SMRESULT);
+                thread_info->wake_mask = wake_mask;
                 thread_info->changed_mask = filter->mask;
                 return 0;
             }
@@ -2775,7 +2898,7 @@ int peek_message( MSG *msg, const struct peek_message_filter *filter )
                 RtlSetLastWin32Error( RtlNtStatusToDosError(res) );
                 return -1;
             }
-            if (!(buffer = malloc( buffer_size ))) return -1;
+            if (!(buffer = alloc_message_buffer( total, &buffer_size ))) return -1;
             continue;
         }
 
@@ -2892,7 +3015,7 @@ int peek_message( MSG *msg, const struct peek_message_filter *filter )
                 thread_info->client_info.message_pos   = MAKELONG( info.msg.pt.x, info.msg.pt.y );
                 thread_info->client_info.message_time  = info.msg.time;
                 thread_info->client_info.message_extra = msg_data->hardware.info;
-                free( buffer );
+                free_message_buffer( buffer, buffer_size );
                 call_hooks( WH_GETMESSAGE, HC_ACTION, flags & PM_REMOVE, (LPARAM)msg, sizeof(*msg) );
                 return 1;
             }
@@ -2907,7 +3030,7 @@ int peek_message( MSG *msg, const struct peek_message_filter *filter )
                     /* if this is a nested call return right away */
                     if (first == info.msg.message && last == info.msg.message)
                     {
-                        free( buffer );
+                        free_message_buffer( buffer, buffer_size );
                         return 0;
                     }
                 }
@@ -2956,7 +3079,7 @@ int peek_message( MSG *msg, const struct peek_message_filter *filter )
             thread_info->client_info.message_time  = info.msg.time;
             thread_info->client_info.message_extra = 0;
             thread_info->client_info.msg_source = msg_source_unavailable;
-            free( buffer );
+            free_message_buffer( buffer, buffer_size );
             call_hooks( WH_GETMESSAGE, HC_ACTION, flags & PM_REMOVE, (LPARAM)msg, sizeof(*msg) );
             return 1;
         }
@@ -3413,10 +3536,11 @@ static LRESULT retrieve_reply( const struct send_message_info *info,
 {
     unsigned int status;
     void *reply_data = NULL;
+    size_t buffer_size = 0;
 
     if (reply_size)
     {
-        if (!(reply_data = malloc( reply_size )))
+        if (!(reply_data = alloc_message_buffer( reply_size, &buffer_size )))
         {
             WARN( "no memory for reply, will be truncated\n" );
             reply_size = 0;
@@ -3433,7 +3557,7 @@ static LRESULT retrieve_reply( const struct send_message_info *info,
     if (!status && reply_size)
         unpack_reply( info->hwnd, info->msg, info->wparam, info->lparam, reply_data, reply_size );
 
-    free( reply_data );
+    if (reply_data) free_message_buffer( reply_data, buffer_size );
 
     TRACE( "hwnd %p msg %x (%s) wp %lx lp %lx got reply %lx (err=%d)\n",
            info->hwnd, info->msg, debugstr_msg_name(info->msg, info->hwnd), (long)info->wparam,
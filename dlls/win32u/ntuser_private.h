@@ -128,6 +128,14 @@ struct user_thread_info
     UINT                          spy_indent;             /* Current spy indent */
     BOOL                          clipping_cursor;        /* thread is currently clipping */
     DWORD                         clipping_reset;         /* time when clipping was last reset */
+    BOOL                          shm_queried;            /* shared memory has been requested from the server */
+    DWORD                         shm_query_time;         /* time of the last shared memory request */
+    const desktop_shm_t          *desktop_shm;            /* desktop shared memory */
+    const queue_shm_t            *queue_shm;              /* message queue shared memory */
+    DWORD                         last_getmsg_time;       /* time of last get_message server call */
+    UINT                          hooks_serial;           /* hooks serial at the time active_hooks was updated */
+    void                         *msg_buffer;             /* cached buffer for received message data */
+    size_t                        msg_buffer_size;        /* size of the cached message buffer */
 };
 
 C_ASSERT( sizeof(struct user_thread_info) <= sizeof(((TEB *)0)->Win32ClientInfo) );
@@ -6209,6 +6209,9 @@ static void thread_detach(void)
 
     destroy_thread_windows();
     cleanup_imm_thread();
+    unmap_user_shared_memory( FALSE );
+    free( thread_info->msg_buffer );
+    thread_info->msg_buffer = NULL;
     NtClose( thread_info->server_queue );
 
     exiting_thread_id = 0;
@@ -195,6 +195,24 @@ extern BOOL get_vulkan_uuid_from_luid( const LUID *luid, GUID *uuid );
 
 /* winstation.c */
 extern BOOL is_virtual_desktop(void);
+extern const desktop_shm_t *get_desktop_shm(void);
+extern const queue_shm_t *get_queue_shm(void);
+extern void unmap_user_shared_memory( BOOL desktop_only );
+
+/* read a consistent snapshot of server shared memory, retrying while the server updates it */
+#define SHARED_READ_BEGIN( shm )                                                  \
+    do {                                                                          \
+        LONG __seq;                                                               \
+        do {                                                                      \
+            while ((__seq = ReadAcquire( (const volatile LONG *)&(shm)->seq )) & 1) \
+                YieldProcessor();                                                 \
+            do
+
+#define SHARED_READ_END( shm )                                                    \
+            while (0);                                                            \
+            MemoryBarrier();                                                      \
+        } while (ReadNoFence( (const volatile LONG *)&(shm)->seq ) != __seq);     \
+    } while (0)
 
 /* window.c */
 struct tagWND;
@@ -22,6 +22,7 @@
 #pragma makedep unix
 #endif
 
+#include <pthread.h>
 #include "ntstatus.h"
 #define WIN32_NO_STATUS
 #include <stdarg.h>
@@ -50,6 +51,163 @@ BOOL is_virtual_desktop(void)
     return !!(flags.dwFlags & DF_WINE_VIRTUAL_DESKTOP);
 }
 
+/* blocks of queue shared memory slots mapped in this process, indexed by server block index */
+static pthread_mutex_t queue_shm_lock = PTHREAD_MUTEX_INITIALIZER;
+static const char **queue_shm_blocks;
+static UINT queue_shm_block_count;
+
+static const void *map_shared_memory( HANDLE handle, SIZE_T size )
+{
+    void *ptr = NULL;
+    LARGE_INTEGER offset = {{0}};
+    NTSTATUS status;
+
+    if (!handle) return NULL;
+    status = NtMapViewOfSection( handle, GetCurrentProcess(), &ptr, 0, 0, &offset,
+                                 &size, ViewUnmap, 0, PAGE_READONLY );
+    NtClose( handle );
+    if (status)
+    {
+        WARN( "failed to map shared memory, status %#x\n", (int)status );
+        return NULL;
+    }
+    return ptr;
+}
+
+/***********************************************************************
+ *           map_queue_shared_memory
+ *
+ * Return the queue shared memory at the given offset of a server block, mapping the block
+ * the first time a thread of the process uses it.
+ */
+static const queue_shm_t *map_queue_shared_memory( HANDLE handle, UINT block, UINT offset )
+{
+    const char *ptr = NULL;
+
+    if (!handle) return NULL;
+
+    pthread_mutex_lock( &queue_shm_lock );
+    if (block < queue_shm_block_count && queue_shm_blocks[block])
+    {
+        ptr = queue_shm_blocks[block];
+        NtClose( handle );
+    }
+    else if ((ptr = map_shared_memory( handle, 0 )))
+    {
+        if (block >= queue_shm_block_count)
+        {
+            UINT count = max( block + 1, queue_shm_block_count * 2 );
+            const char **blocks;
+
+            if (!(blocks = realloc( queue_shm_blocks, count * sizeof(*blocks) )))
+            {
+                NtUnmapViewOfSection( GetCurrentProcess(), (void *)ptr );
+                pthread_mutex_unlock( &queue_shm_lock );
+                return NULL;
+            }
+            memset( blocks + queue_shm_block_count, 0, (count - queue_shm_block_count) * sizeof(*blocks) );
+            queue_shm_blocks = blocks;
+            queue_shm_block_count = count;
+        }
+        queue_shm_blocks[block] = ptr;
+    }
+    pthread_mutex_unlock( &queue_shm_lock );
+
+    return ptr ? (const queue_shm_t *)(ptr + offset) : NULL;
+}
+
+/***********************************************************************
+ *           map_user_shared_memory
+ *
+ * Map the shared memory that the server updates with the thread desktop and queue state.
+ */
+static void map_user_shared_memory( struct user_thread_info *thread_info )
+{
+    HANDLE desktop = 0, queue = 0;
+    UINT queue_block = 0, queue_offset = 0;
+
+    thread_info->shm_queried = TRUE;
+    thread_info->shm_query_time = NtGetTickCount();
+
+    SERVER_START_REQ( get_user_shared_memory )
+    {
+        if (!wine_server_call( req ))
+        {
+            desktop = wine_server_ptr_handle( reply->desktop );
+            queue = wine_server_ptr_handle( reply->queue );
+            queue_block = reply->queue_block;
+            queue_offset = reply->queue_offset;
+        }
+    }
+    SERVER_END_REQ;
+
+    if (!thread_info->desktop_shm)
+        thread_info->desktop_shm = map_shared_memory( desktop, sizeof(desktop_shm_t) );
+    else if (desktop) NtClose( desktop );
+
+    if (!thread_info->queue_shm)
+        thread_info->queue_shm = map_queue_shared_memory( queue, queue_block, queue_offset );
+    else if (queue) NtClose( queue );
+}
+
+/***********************************************************************
+ *           unmap_user_shared_memory
+ */
+void unmap_user_shared_memory( BOOL desktop_only )
+{
+    struct user_thread_info *thread_info = get_user_thread_info();
+
+    if (thread_info->desktop_shm)
+        NtUnmapViewOfSection( GetCurrentProcess(), (void *)thread_info->desktop_shm );
+    thread_info->desktop_shm = NULL;
+    thread_info->shm_queried = FALSE;
+    thread_info->hooks_serial = 0;  /* the global hooks depend on the desktop */
+    if (desktop_only) return;
+
+    /* the queue blocks stay mapped for the other threads of the process */
+    thread_info->queue_shm = NULL;
+}
+
+/***********************************************************************
+ *           check_user_shared_memory
+ */
+static void check_user_shared_memory( struct user_thread_info *thread_info )
+{
+    if (thread_info->shm_queried)
+    {
+        if (thread_info->desktop_shm && thread_info->queue_shm) return;
+        /* retry from time to time if the shared memory wasn't available */
+        if (NtGetTickCount() - thread_info->shm_query_time < 1000) return;
+    }
+    map_user_shared_memory( thread_info );
+}
+
+/***********************************************************************
+ *           get_desktop_shm
+ *
+ * Return the shared memory of the thread desktop, or NULL if not available.
+ */
+const desktop_shm_t *get_desktop_shm(void)
+{
+    struct user_thread_info *thread_info = get_user_thread_info();
+
+    check_user_shared_memory( thread_info );
+    return thread_info->desktop_shm;
+}
+
+/***********************************************************************
+ *           get_queue_shm
+ *
+ * Return the shared memory of the thread message queue, or NULL if not available.
+ */
+const queue_shm_t *get_queue_shm(void)
+{
+    struct user_thread_info *thread_info = get_user_thread_info();
+
+    check_user_shared_memory( thread_info );
+    return thread_info->queue_shm;
+}
+
 /***********************************************************************
  *           NtUserCreateWindowStation  (win32u.@)
  */
@@ -264,6 +422,7 @@ BOOL WINAPI NtUserSetThreadDesktop( HDESK handle )
         thread_info->client_info.top_window = 0;
         thread_info->client_info.msg_window = 0;
         if (key_state_info) key_state_info->time = 0;
+        unmap_user_shared_memory( TRUE );
         if (was_virtual_desktop != is_virtual_desktop()) update_display_cache( TRUE );
     }
     return ret;
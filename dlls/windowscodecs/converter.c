@@ -89,6 +89,49 @@ static inline float to_sRGB_component(float f)
     return 1.055f * powf(f, 1.0f/2.4f) - 0.055f;
 }
 
+static inline BYTE to_sRGB_byte_slow(float f)
+{
+    return floorf(to_sRGB_component(f) * 255.0f + 0.51f);
+}
+
+/* srgb_thresholds[v] is the smallest linear value in [0, 1] that converts to
+ * sRGB byte value v, so a lookup gives the same result as to_sRGB_byte_slow(). */
+static float srgb_thresholds[256];
+static INIT_ONCE srgb_thresholds_once = INIT_ONCE_STATIC_INIT;
+
+static BOOL WINAPI init_srgb_thresholds(INIT_ONCE *once, void *param, void **context)
+{
+    union { float f; UINT32 u; } lo, hi, mid;
+    unsigned int v;
+
+    srgb_thresholds[0] = 0.0f;
+    for (v = 1; v < 256; v++)
+    {
+        /* non-negative floats are ordered like their bit patterns */
+        lo.f = srgb_thresholds[v - 1];
+        hi.f = 1.0f;
+        while (lo.u < hi.u)
+        {
+            mid.u = lo.u + (hi.u - lo.u) / 2;
+            if (to_sRGB_byte_slow(mid.f) >= v) hi.u = mid.u;
+            else lo.u = mid.u + 1;
+        }
+        srgb_thresholds[v] = hi.f;
+    }
+    return TRUE;
+}
+
+static inline BYTE to_sRGB_byte(float f)
+{
+    unsigned int v = 0, step;
+
+    if (!(f >= 0.0f && f <= 1.0f)) return to_sRGB_byte_slow(f);
+
+    for (step = 128; step; step >>= 1)
+        if (f >= srgb_thresholds[v + step]) v += step;
+    return v;
+}
+
 #if 0 /* FIXME: enable once needed */
 static inline float from_sRGB_component(float f)
 {
@@ -1130,6 +1173,8 @@ static HRESULT copypixels_to_24bppBGR(struct FormatConverter *This, const WICRec
                 INT x, y;
                 BYTE *src = srcdata, *dst = pbBuffer;
 
+                InitOnceExecuteOnce(&srgb_thresholds_once, init_srgb_thresholds, NULL, NULL);
+
                 for (y = 0; y < prc->Height; y++)
                 {
                     float *gray_float = (float *)src;
@@ -1137,7 +1182,7 @@ static HRESULT copypixels_to_24bppBGR(struct FormatConverter *This, const WICRec
 
                     for (x = 0; x < prc->Width; x++)
                     {
-                        BYTE gray = (BYTE)floorf(to_sRGB_component(gray_float[x]) * 255.0f + 0.51f);
+                        BYTE gray = to_sRGB_byte(gray_float[x]);
                         *bgr++ = gray;
                         *bgr++ = gray;
                         *bgr++ = gray;
@@ -1350,13 +1395,15 @@ static HRESULT copypixels_to_8bppGray(struct FormatConverter *This, const WICRec
                 INT x, y;
                 BYTE *src = srcdata, *dst = pbBuffer;
 
+                InitOnceExecuteOnce(&srgb_thresholds_once, init_srgb_thresholds, NULL, NULL);
+
                 for (y=0; y < prc->Height; y++)
                 {
                     float *srcpixel = (float*)src;
                     BYTE *dstpixel = dst;
 
                     for (x=0; x < prc->Width; x++)
-                        *dstpixel++ = (BYTE)floorf(to_sRGB_component(*srcpixel++) * 255.0f + 0.51f);
+                        *dstpixel++ = to_sRGB_byte(*srcpixel++);
 
                     src += srcstride;
                     dst += cbStride;
@@ -1384,6 +1431,8 @@ static HRESULT copypixels_to_8bppGray(struct FormatConverter *This, const WICRec
         INT x, y;
         BYTE *src = srcdata, *dst = pbBuffer;
 
+        InitOnceExecuteOnce(&srgb_thresholds_once, init_srgb_thresholds, NULL, NULL);
+
         for (y = 0; y < prc->Height; y++)
         {
             BYTE *bgr = src;
@@ -1392,8 +1441,7 @@ static HRESULT copypixels_to_8bppGray(struct FormatConverter *This, const WICRec
             {
                 float gray = (bgr[2] * 0.2126f + bgr[1] * 0.7152f + bgr[0] * 0.0722f) / 255.0f;
 
-                gray = to_sRGB_component(gray) * 255.0f;
-                dst[x] = (BYTE)floorf(gray + 0.51f);
+                dst[x] = to_sRGB_byte(gray);
                 bgr += 3;
             }
             src += srcstride;
@@ -78,8 +78,14 @@ struct jpeg_decoder {
     struct jpeg_error_mgr jerr;
     struct jpeg_source_mgr source_mgr;
     BYTE source_buffer[1024];
+    J_COLOR_SPACE out_color_space;
+    ULONGLONG stream_pos;
+    BOOL restart_needed;
     UINT stride;
-    BYTE *image_data;
+    /* Only the rows of the last copy_pixels call are kept decoded. They
+     * always end at the current output scanline. */
+    BYTE *band;
+    UINT band_y, band_height;
 };
 
 static inline struct jpeg_decoder *impl_from_decoder(struct decoder* iface)
@@ -97,7 +103,7 @@ static void CDECL jpeg_decoder_destroy(struct decoder* iface)
     struct jpeg_decoder *This = impl_from_decoder(iface);
 
     if (This->cinfo_initialized) jpeg_destroy_decompress(&This->cinfo);
-    free(This->image_data);
+    free(This->band);
     free(This);
 }
 
@@ -150,7 +156,6 @@ static HRESULT CDECL jpeg_decoder_initialize(struct decoder* iface, IStream *str
     struct jpeg_decoder *This = impl_from_decoder(iface);
     int ret;
     jmp_buf jmpbuf;
-    UINT data_size, i;
 
     if (This->cinfo_initialized)
         return WINCODEC_ERR_WRONGSTATE;
@@ -194,19 +199,19 @@ static HRESULT CDECL jpeg_decoder_initialize(struct decoder* iface, IStream *str
     switch (This->cinfo.jpeg_color_space)
     {
     case JCS_GRAYSCALE:
-        This->cinfo.out_color_space = JCS_GRAYSCALE;
+        This->out_color_space = JCS_GRAYSCALE;
         This->frame.bpp = 8;
         This->frame.pixel_format = GUID_WICPixelFormat8bppGray;
         break;
     case JCS_RGB:
     case JCS_YCbCr:
-        This->cinfo.out_color_space = JCS_RGB;
+        This->out_color_space = JCS_RGB;
         This->frame.bpp = 24;
         This->frame.pixel_format = GUID_WICPixelFormat24bppBGR;
         break;
     case JCS_CMYK:
     case JCS_YCCK:
-        This->cinfo.out_color_space = JCS_CMYK;
+        This->out_color_space = JCS_CMYK;
         This->frame.bpp = 32;
         This->frame.pixel_format = GUID_WICPixelFormat32bppCMYK;
         break;
@@ -215,6 +220,7 @@ static HRESULT CDECL jpeg_decoder_initialize(struct decoder* iface, IStream *str
         return E_FAIL;
     }
 
+    This->cinfo.out_color_space = This->out_color_space;
     if (!jpeg_start_decompress(&This->cinfo))
     {
         ERR("jpeg_start_decompress failed\n");
@@ -246,45 +252,9 @@ static HRESULT CDECL jpeg_decoder_initialize(struct decoder* iface, IStream *str
     This->frame.num_colors = 0;
 
     This->stride = (This->frame.bpp * This->cinfo.output_width + 7) / 8;
-    data_size = This->stride * This->cinfo.output_height;
 
-    This->image_data = malloc(data_size);
-    if (!This->image_data)
-        return E_OUTOFMEMORY;
-
-    while (This->cinfo.output_scanline < This->cinfo.output_height)
-    {
-        UINT first_scanline = This->cinfo.output_scanline;
-        UINT max_rows;
-        JSAMPROW out_rows[4];
-        JDIMENSION ret;
-
-        max_rows = min(This->cinfo.output_height-first_scanline, 4);
-        for (i=0; i<max_rows; i++)
-            out_rows[i] = This->image_data + This->stride * (first_scanline+i);
-
-        ret = jpeg_read_scanlines(&This->cinfo, out_rows, max_rows);
-        if (ret == 0)
-        {
-            ERR("read_scanlines failed\n");
-            return E_FAIL;
-        }
-    }
-
-    if (This->frame.bpp == 24)
-    {
-        /* libjpeg gives us RGB data and we want BGR, so byteswap the data */
-        reverse_bgr8(3, This->image_data,
-            This->cinfo.output_width, This->cinfo.output_height,
-            This->stride);
-    }
-
-    if (This->cinfo.out_color_space == JCS_CMYK && This->cinfo.saw_Adobe_marker)
-    {
-        /* Adobe JPEG's have inverted CMYK data. */
-        for (i=0; i<data_size; i++)
-            This->image_data[i] ^= 0xff;
-    }
+    /* Scanlines are decoded on demand by copy_pixels. */
+    stream_seek(This->stream, 0, STREAM_SEEK_CUR, &This->stream_pos);
 
     st->frame_count = 1;
     st->flags = WICBitmapDecoderCapabilityCanDecodeAllImages |
@@ -301,13 +271,147 @@ static HRESULT CDECL jpeg_decoder_get_frame_info(struct decoder* iface, UINT fra
     return S_OK;
 }
 
+/* Must be called with an error handler set up. */
+static HRESULT jpeg_decoder_restart(struct jpeg_decoder *This)
+{
+    int ret;
+
+    jpeg_abort_decompress(&This->cinfo);
+
+    stream_seek(This->stream, 0, STREAM_SEEK_SET, NULL);
+    This->source_mgr.bytes_in_buffer = 0;
+
+    if ((ret = jpeg_read_header(&This->cinfo, TRUE)) != JPEG_HEADER_OK)
+    {
+        WARN("Jpeg image in stream has bad format, read header returned %d.\n", ret);
+        return WINCODEC_ERR_BADIMAGE;
+    }
+
+    This->cinfo.out_color_space = This->out_color_space;
+    if (!jpeg_start_decompress(&This->cinfo))
+    {
+        ERR("jpeg_start_decompress failed\n");
+        return WINCODEC_ERR_BADIMAGE;
+    }
+
+    return S_OK;
+}
+
+/* Must be called with an error handler set up. */
+static BOOL jpeg_decoder_read_rows(struct jpeg_decoder *This, BYTE *data, UINT count)
+{
+    UINT i, max_rows;
+    JSAMPROW out_rows[4];
+
+    while (count)
+    {
+        max_rows = min(count, 4);
+        for (i=0; i<max_rows; i++)
+            out_rows[i] = data + This->stride * i;
+
+        max_rows = jpeg_read_scanlines(&This->cinfo, out_rows, max_rows);
+        if (max_rows == 0)
+        {
+            ERR("read_scanlines failed\n");
+            return FALSE;
+        }
+
+        if (This->frame.bpp == 24)
+        {
+            /* libjpeg gives us RGB data and we want BGR, so byteswap the data */
+            reverse_bgr8(3, data, This->cinfo.output_width, max_rows, This->stride);
+        }
+
+        if (This->cinfo.out_color_space == JCS_CMYK && This->cinfo.saw_Adobe_marker)
+        {
+            /* Adobe JPEG's have inverted CMYK data. */
+            for (i=0; i<This->stride * max_rows; i++)
+                data[i] ^= 0xff;
+        }
+
+        data += This->stride * max_rows;
+        count -= max_rows;
+    }
+
+    return TRUE;
+}
+
 static HRESULT CDECL jpeg_decoder_copy_pixels(struct decoder* iface, UINT frame,
     const WICRect *prc, UINT stride, UINT buffersize, BYTE *buffer)
 {
     struct jpeg_decoder *This = impl_from_decoder(iface);
-    return copy_pixels(This->frame.bpp, This->image_data,
-        This->frame.width, This->frame.height, This->stride,
-        prc, stride, buffersize, buffer);
+    UINT first = prc->Y, last = prc->Y + prc->Height, band_end = This->band_y + This->band_height;
+    UINT decode_start;
+    BYTE *band, *skip_row;
+    jmp_buf jmpbuf;
+    WICRect rect;
+    HRESULT hr;
+
+    if (first < This->band_y || last > band_end)
+    {
+        /* Rows already in the current band are reused, the rest is decoded
+         * sequentially. Going backwards requires decoding from the start. */
+        decode_start = (first >= This->band_y && first < band_end) ? band_end : first;
+
+        band = malloc(This->stride * (last - first));
+        skip_row = malloc(This->stride);
+        if (!band || !skip_row)
+        {
+            free(band);
+            free(skip_row);
+            return E_OUTOFMEMORY;
+        }
+
+        if (decode_start > first)
+            memcpy(band, This->band + This->stride * (first - This->band_y), This->stride * (decode_start - first));
+
+        This->cinfo.client_data = jmpbuf;
+
+        if (setjmp(jmpbuf))
+        {
+            This->restart_needed = TRUE;
+            free(band);
+            free(skip_row);
+            return E_FAIL;
+        }
+
+        stream_seek(This->stream, This->stream_pos, STREAM_SEEK_SET, NULL);
+
+        if (This->restart_needed || decode_start < This->cinfo.output_scanline)
+        {
+            if (FAILED(hr = jpeg_decoder_restart(This)))
+            {
+                This->restart_needed = TRUE;
+                free(band);
+                free(skip_row);
+                return hr;
+            }
+            This->restart_needed = FALSE;
+        }
+
+        while (This->cinfo.output_scanline < decode_start)
+        {
+            if (!jpeg_read_scanlines(&This->cinfo, &skip_row, 1))
+                longjmp(jmpbuf, 1);
+        }
+
+        if (!jpeg_decoder_read_rows(This, band + This->stride * (decode_start - first), last - decode_start))
+            longjmp(jmpbuf, 1);
+
+        stream_seek(This->stream, 0, STREAM_SEEK_CUR, &This->stream_pos);
+
+        free(skip_row);
+        free(This->band);
+        This->band = band;
+        This->band_y = first;
+        This->band_height = last - first;
+    }
+
+    rect = *prc;
+    rect.Y -= This->band_y;
+    return copy_pixels(This->frame.bpp, This->band,
+        This->frame.width, This->band_height, This->stride,
+        &rect, stride, buffersize, buffer);
 }
 
 static HRESULT CDECL jpeg_decoder_get_metadata_blocks(struct decoder* iface, UINT frame,
@@ -346,7 +450,9 @@ HRESULT CDECL jpeg_decoder_create(struct decoder_info *info, struct decoder **re
     This->decoder.vtable = &jpeg_decoder_vtable;
     This->cinfo_initialized = FALSE;
     This->stream = NULL;
-    This->image_data = NULL;
+    This->restart_needed = FALSE;
+    This->band = NULL;
+    This->band_y = This->band_height = 0;
     *result = &This->decoder;
 
     info->container_format = GUID_ContainerFormatJpeg;
@@ -33,13 +33,31 @@
 
 WINE_DEFAULT_DEBUG_CHANNEL(wincodecs);
 
+enum png_decoder_transform
+{
+    TRANSFORM_SWAP = 0x1,
+    TRANSFORM_GRAY_TO_RGB = 0x2,
+    TRANSFORM_TRNS_TO_ALPHA = 0x4,
+    TRANSFORM_BGR = 0x8,
+};
+
 struct png_decoder
 {
     struct decoder decoder;
     IStream *stream;
     struct decoder_frame decoder_frame;
+    png_structp png_ptr;
+    png_infop info_ptr;
+    UINT transforms;
+    BOOL interlaced;
+    BOOL restart_needed;
+    ULONGLONG stream_pos;
+    UINT next_row;
     UINT stride;
-    BYTE *image_bits;
+    /* Only the rows of the last copy_pixels call are kept decoded. They
+     * always end at next_row. */
+    BYTE *band;
+    UINT band_y, band_height;
     BYTE *color_profile;
     DWORD color_profile_len;
 };
@@ -62,6 +80,20 @@ static void user_read_data(png_structp png_ptr, png_bytep data, png_size_t lengt
     }
 }
 
+/* returns the number of passes needed to read the image row by row */
+static int png_decoder_start_read(png_structp png_ptr, UINT transforms)
+{
+    int passes;
+
+    if (transforms & TRANSFORM_SWAP) png_set_swap(png_ptr);
+    if (transforms & TRANSFORM_GRAY_TO_RGB) png_set_gray_to_rgb(png_ptr);
+    if (transforms & TRANSFORM_TRNS_TO_ALPHA) png_set_tRNS_to_alpha(png_ptr);
+    if (transforms & TRANSFORM_BGR) png_set_bgr(png_ptr);
+    passes = png_set_interlace_handling(png_ptr);
+    png_start_read_image(png_ptr);
+    return passes;
+}
+
 static HRESULT CDECL png_decoder_initialize(struct decoder *iface, IStream *stream, struct decoder_stat *st)
 {
     struct png_decoder *This = impl_from_decoder(iface);
@@ -77,9 +109,8 @@ static HRESULT CDECL png_decoder_initialize(struct decoder *iface, IStream *stre
     int unit_type;
     png_colorp png_palette;
     int num_palette;
-    int i;
-    UINT image_size;
-    png_bytep *row_pointers=NULL;
+    int i, passes;
+    png_bytep row;
     png_charp cp_name;
     png_bytep cp_profile;
     png_uint_32 cp_len;
@@ -125,8 +156,9 @@ static HRESULT CDECL png_decoder_initialize(struct decoder *iface, IStream *stre
     bit_depth = png_get_bit_depth(png_ptr, info_ptr);
 
     /* PNGs with bit-depth greater than 8 are network byte order. Windows does not expect this. */
+    This->transforms = 0;
     if (bit_depth > 8)
-        png_set_swap(png_ptr);
+        This->transforms |= TRANSFORM_SWAP;
 
     /* check for color-keyed alpha */
     transparency = png_get_tRNS(png_ptr, info_ptr, &trans, &num_trans, &trans_values);
@@ -138,8 +170,8 @@ static HRESULT CDECL png_decoder_initialize(struct decoder *iface, IStream *stre
     {
         /* expand to RGBA */
         if (color_type == PNG_COLOR_TYPE_GRAY)
-            png_set_gray_to_rgb(png_ptr);
-        png_set_tRNS_to_alpha(png_ptr);
+            This->transforms |= TRANSFORM_GRAY_TO_RGB;
+        This->transforms |= TRANSFORM_TRNS_TO_ALPHA;
         color_type = PNG_COLOR_TYPE_RGB_ALPHA;
     }
 
@@ -147,14 +179,14 @@ static HRESULT CDECL png_decoder_initialize(struct decoder *iface, IStream *stre
     {
     case PNG_COLOR_TYPE_GRAY_ALPHA:
         /* WIC does not support grayscale alpha formats so use RGBA */
-        png_set_gray_to_rgb(png_ptr);
+        This->transforms |= TRANSFORM_GRAY_TO_RGB;
         /* fall through */
     case PNG_COLOR_TYPE_RGB_ALPHA:
         This->decoder_frame.bpp = bit_depth * 4;
         switch (bit_depth)
         {
         case 8:
-            png_set_bgr(png_ptr);
+            This->transforms |= TRANSFORM_BGR;
             This->decoder_frame.pixel_format = GUID_WICPixelFormat32bppBGRA;
             break;
         case 16: This->decoder_frame.pixel_format = GUID_WICPixelFormat64bppRGBA; break;
@@ -202,7 +234,7 @@ static HRESULT CDECL png_decoder_initialize(struct decoder *iface, IStream *stre
         switch (bit_depth)
         {
         case 8:
-            png_set_bgr(png_ptr);
+            This->transforms |= TRANSFORM_BGR;
             This->decoder_frame.pixel_format = GUID_WICPixelFormat24bppBGR;
             break;
         case 16: This->decoder_frame.pixel_format = GUID_WICPixelFormat48bppRGB; break;
@@ -294,31 +326,30 @@ static HRESULT CDECL png_decoder_initialize(struct decoder *iface, IStream *stre
     }
 
     This->stride = (This->decoder_frame.width * This->decoder_frame.bpp + 7) / 8;
-    image_size = This->stride * This->decoder_frame.height;
+    This->interlaced = png_get_interlace_type(png_ptr, info_ptr) != PNG_INTERLACE_NONE;
 
-    This->image_bits = malloc(image_size);
-    if (!This->image_bits)
+    /* Decode the image data once, so that truncated or corrupt images fail
+     * to load as they did when the whole image was kept. Only one row is
+     * kept at a time, copy_pixels decodes the rows again on demand. */
+    passes = png_decoder_start_read(png_ptr, This->transforms);
+    if (!(row = malloc(This->stride)))
     {
         hr = E_OUTOFMEMORY;
         goto end;
     }
-
-    row_pointers = malloc(sizeof(png_bytep)*This->decoder_frame.height);
-    if (!row_pointers)
+    if (setjmp(png_jmpbuf(png_ptr)))
     {
-        hr = E_OUTOFMEMORY;
+        free(row);
+        hr = WINCODEC_ERR_UNKNOWNIMAGEFORMAT;
         goto end;
     }
+    for (i = 0; i < passes * This->decoder_frame.height; i++)
+        png_read_row(png_ptr, row, NULL);
+    free(row);
 
-    for (i=0; i<This->decoder_frame.height; i++)
-        row_pointers[i] = This->image_bits + i * This->stride;
-
-    png_read_image(png_ptr, row_pointers);
-
-    free(row_pointers);
-    row_pointers = NULL;
-
-    /* png_read_end intentionally not called to not seek to the end of the file */
+    This->next_row = This->decoder_frame.height;
+    This->restart_needed = TRUE;
+    This->stream_pos = 0;
 
     st->flags = WICBitmapDecoderCapabilityCanDecodeAllImages |
                 WICBitmapDecoderCapabilityCanDecodeSomeImages |
@@ -326,16 +357,15 @@ static HRESULT CDECL png_decoder_initialize(struct decoder *iface, IStream *stre
     st->frame_count = 1;
 
     This->stream = stream;
+    This->png_ptr = png_ptr;
+    This->info_ptr = info_ptr;
 
     hr = S_OK;
 
 end:
-    png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
-    free(row_pointers);
     if (FAILED(hr))
     {
-        free(This->image_bits);
-        This->image_bits = NULL;
+        png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
         free(This->color_profile);
         This->color_profile = NULL;
     }
@@ -349,14 +379,148 @@ static HRESULT CDECL png_decoder_get_frame_info(struct decoder *iface, UINT fram
     return S_OK;
 }
 
+static HRESULT png_decoder_restart(struct png_decoder *This)
+{
+    png_structp png_ptr;
+    png_infop info_ptr;
+
+    This->restart_needed = TRUE;
+    png_destroy_read_struct(&This->png_ptr, &This->info_ptr, NULL);
+
+    png_ptr = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+    if (!png_ptr)
+        return E_FAIL;
+
+    info_ptr = png_create_info_struct(png_ptr);
+    if (!info_ptr)
+    {
+        png_destroy_read_struct(&png_ptr, NULL, NULL);
+        return E_FAIL;
+    }
+
+    This->png_ptr = png_ptr;
+    This->info_ptr = info_ptr;
+
+    if (setjmp(png_jmpbuf(png_ptr)))
+        return E_FAIL;
+    png_set_crc_action(png_ptr, PNG_CRC_QUIET_USE, PNG_CRC_QUIET_USE);
+    png_set_chunk_malloc_max(png_ptr, 0);
+
+    stream_seek(This->stream, 0, STREAM_SEEK_SET, NULL);
+    png_set_read_fn(png_ptr, This->stream, user_read_data);
+    png_read_info(png_ptr, info_ptr);
+    png_decoder_start_read(png_ptr, This->transforms);
+
+    This->next_row = 0;
+    This->restart_needed = FALSE;
+    return S_OK;
+}
+
 static HRESULT CDECL png_decoder_copy_pixels(struct decoder *iface, UINT frame,
     const WICRect *prc, UINT stride, UINT buffersize, BYTE *buffer)
 {
     struct png_decoder *This = impl_from_decoder(iface);
+    UINT first = prc->Y, last = prc->Y + prc->Height, band_end = This->band_y + This->band_height;
+    UINT decode_start, i;
+    png_bytep *row_pointers = NULL;
+    BYTE *band, *skip_row;
+    ULONGLONG saved_pos = 0;
+    BOOL restore_pos = FALSE;
+    HRESULT hr;
+    WICRect rect;
+
+    if (first < This->band_y || last > band_end)
+    {
+        /* Interlaced images can only be decoded as a whole. */
+        if (This->interlaced)
+        {
+            first = 0;
+            last = This->decoder_frame.height;
+        }
+
+        /* Rows already in the current band are reused, the rest is decoded
+         * sequentially. Going backwards requires decoding from the start. */
+        decode_start = (first >= This->band_y && first < band_end) ? band_end : first;
+
+        band = malloc(This->stride * (last - first));
+        skip_row = malloc(This->stride);
+        if (This->interlaced)
+            row_pointers = malloc(sizeof(png_bytep) * This->decoder_frame.height);
+        if (!band || !skip_row || (This->interlaced && !row_pointers))
+        {
+            hr = E_OUTOFMEMORY;
+            goto fail;
+        }
+
+        if (decode_start > first)
+            memcpy(band, This->band + This->stride * (first - This->band_y), This->stride * (decode_start - first));
+
+        /* Metadata readers share the stream, so its position is restored
+         * once the rows have been decoded. */
+        hr = stream_seek(This->stream, 0, STREAM_SEEK_CUR, &saved_pos);
+        if (FAILED(hr))
+            goto fail;
+        restore_pos = TRUE;
+
+        hr = stream_seek(This->stream, This->stream_pos, STREAM_SEEK_SET, NULL);
+        if (FAILED(hr))
+            goto fail;
 
-    return copy_pixels(This->decoder_frame.bpp, This->image_bits,
-        This->decoder_frame.width, This->decoder_frame.height, This->stride,
-        prc, stride, buffersize, buffer);
+        if (This->restart_needed || decode_start < This->next_row)
+        {
+            hr = png_decoder_restart(This);
+            if (FAILED(hr))
+                goto fail;
+        }
+
+        if (setjmp(png_jmpbuf(This->png_ptr)))
+        {
+            This->restart_needed = TRUE;
+            hr = E_FAIL;
+            goto fail;
+        }
+
+        if (This->interlaced)
+        {
+            for (i = 0; i < This->decoder_frame.height; i++)
+                row_pointers[i] = band + i * This->stride;
+            png_read_image(This->png_ptr, row_pointers);
+            This->next_row = This->decoder_frame.height;
+        }
+        else
+        {
+            for (; This->next_row < decode_start; This->next_row++)
+                png_read_row(This->png_ptr, skip_row, NULL);
+            for (; This->next_row < last; This->next_row++)
+                png_read_row(This->png_ptr, band + This->stride * (This->next_row - first), NULL);
+        }
+
+        /* png_read_end intentionally not called to not seek to the end of the file */
+
+        stream_seek(This->stream, 0, STREAM_SEEK_CUR, &This->stream_pos);
+        stream_seek(This->stream, saved_pos, STREAM_SEEK_SET, NULL);
+
+        free(row_pointers);
+        free(skip_row);
+        free(This->band);
+        This->band = band;
+        This->band_y = first;
+        This->band_height = last - first;
+    }
+
+    rect = *prc;
+    rect.Y -= This->band_y;
+    return copy_pixels(This->decoder_frame.bpp, This->band,
+        This->decoder_frame.width, This->band_height, This->stride,
+        &rect, stride, buffersize, buffer);
+
+fail:
+    if (restore_pos)
+        stream_seek(This->stream, saved_pos, STREAM_SEEK_SET, NULL);
+    free(row_pointers);
+    free(skip_row);
+    free(band);
+    return hr;
 }
 
 static HRESULT CDECL png_decoder_get_metadata_blocks(struct decoder* iface,
@@ -451,7 +615,8 @@ static void CDECL png_decoder_destroy(struct decoder* iface)
 {
     struct png_decoder *This = impl_from_decoder(iface);
 
-    free(This->image_bits);
+    png_destroy_read_struct(&This->png_ptr, &This->info_ptr, NULL);
+    free(This->band);
     free(This->color_profile);
     free(This);
 }
@@ -477,7 +642,11 @@ HRESULT CDECL png_decoder_create(struct decoder_info *info, struct decoder **res
     }
 
     This->decoder.vtable = &png_decoder_vtable;
-    This->image_bits = NULL;
+    This->png_ptr = NULL;
+    This->info_ptr = NULL;
+    This->restart_needed = FALSE;
+    This->band = NULL;
+    This->band_y = This->band_height = 0;
     This->color_profile = NULL;
     *result = &This->decoder;
 
@@ -18,6 +18,7 @@
  */
 
 #include <stdarg.h>
+#include <math.h>
 
 #define COBJMACROS
 
@@ -31,6 +32,15 @@
 
 WINE_DEFAULT_DEBUG_CHANNEL(wincodecs);
 
+/* Source pixels contributing to each destination pixel along one axis. */
+struct scaler_filter
+{
+    UINT *start;
+    UINT *count;
+    float *weights; /* max_count weights per destination pixel */
+    UINT max_count;
+};
+
 typedef struct BitmapScaler {
     IWICBitmapScaler IWICBitmapScaler_iface;
     LONG ref;
@@ -42,9 +52,19 @@ typedef struct BitmapScaler {
     UINT bpp;
     void (*fn_get_required_source_rect)(struct BitmapScaler*,UINT,UINT,WICRect*);
     void (*fn_copy_scanline)(struct BitmapScaler*,UINT,UINT,UINT,BYTE**,UINT,UINT,BYTE*);
+    struct scaler_filter filter_x, filter_y;
+    float *filter_row;
+    BOOL straight_alpha; /* filter with premultiplied alpha */
     CRITICAL_SECTION lock; /* must be held when initialized */
 } BitmapScaler;
 
+static void free_scaler_filter(struct scaler_filter *filter)
+{
+    free(filter->start);
+    free(filter->count);
+    free(filter->weights);
+}
+
 static inline BitmapScaler *impl_from_IWICBitmapScaler(IWICBitmapScaler *iface)
 {
     return CONTAINING_RECORD(iface, BitmapScaler, IWICBitmapScaler_iface);
@@ -106,6 +126,9 @@ static ULONG WINAPI BitmapScaler_Release(IWICBitmapScaler *iface)
         This->lock.DebugInfo->Spare[0] = 0;
         DeleteCriticalSection(&This->lock);
         if (This->source) IWICBitmapSource_Release(This->source);
+        free_scaler_filter(&This->filter_x);
+        free_scaler_filter(&This->filter_y);
+        free(This->filter_row);
         free(This);
     }
 
@@ -203,6 +226,186 @@ static void NearestNeighbor_CopyScanline(BitmapScaler *This,
     }
 }
 
+static float linear_weight(float x)
+{
+    x = fabsf(x);
+    return x < 1.0f ? 1.0f - x : 0.0f;
+}
+
+/* Keys cubic convolution with a = -0.5 (Catmull-Rom). */
+static float cubic_weight(float x)
+{
+    x = fabsf(x);
+    if (x < 1.0f) return (1.5f * x - 2.5f) * x * x + 1.0f;
+    if (x < 2.0f) return ((-0.5f * x + 2.5f) * x - 4.0f) * x + 2.0f;
+    return 0.0f;
+}
+
+static HRESULT init_scaler_filter(struct scaler_filter *filter, UINT src_size, UINT dst_size,
+    WICBitmapInterpolationMode mode)
+{
+    double scale = (double)src_size / dst_size, filter_scale, radius;
+    UINT i, j;
+
+    /* Linear is plain bilinear interpolation. Cubic widens its kernel when
+     * downscaling, and Fant averages the covered source area, so both of them
+     * take every source pixel into account. */
+    filter_scale = (mode != WICBitmapInterpolationModeLinear && scale > 1.0) ? scale : 1.0;
+    if (mode == WICBitmapInterpolationModeFant)
+        radius = filter_scale / 2.0 + 0.5;
+    else if (mode == WICBitmapInterpolationModeCubic)
+        radius = 2.0 * filter_scale;
+    else
+        radius = 1.0;
+
+    filter->max_count = (UINT)ceil(2.0 * radius) + 2;
+    filter->start = malloc(dst_size * sizeof(*filter->start));
+    filter->count = malloc(dst_size * sizeof(*filter->count));
+    filter->weights = calloc(dst_size * filter->max_count, sizeof(*filter->weights));
+    if (!filter->start || !filter->count || !filter->weights)
+    {
+        free_scaler_filter(filter);
+        memset(filter, 0, sizeof(*filter));
+        return E_OUTOFMEMORY;
+    }
+
+    for (i = 0; i < dst_size; i++)
+    {
+        double center = (i + 0.5) * scale - 0.5;
+        float *weights = filter->weights + i * filter->max_count;
+        INT first = floor(center - radius), last = ceil(center + radius), x;
+        float sum = 0.0f, w;
+
+        /* Pixels outside of the source repeat the edge pixels. */
+        filter->start[i] = max(first, 0);
+        filter->count[i] = min(last, (INT)src_size - 1) - filter->start[i] + 1;
+
+        for (x = first; x <= last; x++)
+        {
+            if (mode == WICBitmapInterpolationModeFant)
+                w = max(0.0, min(x + 0.5, center + filter_scale / 2.0) - max(x - 0.5, center - filter_scale / 2.0));
+            else if (mode == WICBitmapInterpolationModeCubic)
+                w = cubic_weight((x - center) / filter_scale);
+            else
+                w = linear_weight(x - center);
+
+            j = min(max(x, 0), (INT)src_size - 1) - filter->start[i];
+            weights[j] += w;
+            sum += w;
+        }
+
+        if (sum != 0.0f)
+        {
+            for (j = 0; j < filter->count[i]; j++)
+                weights[j] /= sum;
+        }
+    }
+
+    return S_OK;
+}
+
+static void Filtered_GetRequiredSourceRect(BitmapScaler *This,
+    UINT x, UINT y, WICRect *src_rect)
+{
+    src_rect->X = This->filter_x.start[x];
+    src_rect->Y = This->filter_y.start[y];
+    src_rect->Width = This->filter_x.count[x];
+    src_rect->Height = This->filter_y.count[y];
+}
+
+static void Filtered_CopyScanline(BitmapScaler *This,
+    UINT dst_x, UINT dst_y, UINT dst_width,
+    BYTE **src_data, UINT src_data_x, UINT src_data_y, BYTE *pbBuffer)
+{
+    const struct scaler_filter *filter_x = &This->filter_x, *filter_y = &This->filter_y;
+    const float *weights = filter_y->weights + dst_y * filter_y->max_count;
+    UINT channels = This->bpp / 8;
+    UINT row_x = filter_x->start[dst_x];
+    UINT row_size = (filter_x->start[dst_x + dst_width - 1] + filter_x->count[dst_x + dst_width - 1] - row_x) * channels;
+    float *row = This->filter_row;
+    UINT i, j, c;
+
+    /* Filter vertically into a float row first, then horizontally into the
+     * destination. Both loops run over contiguous data, so the compiler is
+     * free to vectorize them. Straight alpha is premultiplied in the float
+     * row, so that the color of transparent pixels doesn't bleed into their
+     * neighbours. */
+    for (j = 0; j < filter_y->count[dst_y]; j++)
+    {
+        const BYTE *src = src_data[filter_y->start[dst_y] + j - src_data_y] + (row_x - src_data_x) * channels;
+        float w = weights[j];
+
+        if (This->straight_alpha)
+        {
+            if (!j) memset(row, 0, row_size * sizeof(*row));
+            for (i = 0; i < row_size; i += 4)
+            {
+                float a = w * src[i + 3], wa = a / 255.0f;
+
+                row[i] += wa * src[i];
+                row[i + 1] += wa * src[i + 1];
+                row[i + 2] += wa * src[i + 2];
+                row[i + 3] += a;
+            }
+        }
+        else if (!j)
+        {
+            for (i = 0; i < row_size; i++) row[i] = w * src[i];
+        }
+        else
+        {
+            for (i = 0; i < row_size; i++) row[i] += w * src[i];
+        }
+    }
+
+    for (i = 0; i < dst_width; i++)
+    {
+        UINT x = dst_x + i;
+        const float *src = row + (filter_x->start[x] - row_x) * channels;
+        float sum[4];
+
+        weights = filter_x->weights + x * filter_x->max_count;
+        for (c = 0; c < channels; c++)
+        {
+            sum[c] = 0.0f;
+            for (j = 0; j < filter_x->count[x]; j++)
+                sum[c] += weights[j] * src[j * channels + c];
+        }
+
+        if (This->straight_alpha && sum[3] > 0.0f)
+        {
+            for (c = 0; c < 3; c++) sum[c] = sum[c] * 255.0f / sum[3];
+        }
+
+        for (c = 0; c < channels; c++)
+        {
+            float value = sum[c] + 0.5f;
+            *pbBuffer++ = value <= 0.0f ? 0 : value >= 255.0f ? 255 : (BYTE)value;
+        }
+    }
+}
+
+static BOOL is_filterable_format(const WICPixelFormatGUID *format)
+{
+    static const WICPixelFormatGUID *formats[] =
+    {
+        &GUID_WICPixelFormat8bppGray,
+        &GUID_WICPixelFormat24bppBGR,
+        &GUID_WICPixelFormat24bppRGB,
+        &GUID_WICPixelFormat32bppBGR,
+        &GUID_WICPixelFormat32bppRGB,
+        &GUID_WICPixelFormat32bppBGRA,
+        &GUID_WICPixelFormat32bppRGBA,
+        &GUID_WICPixelFormat32bppPBGRA,
+        &GUID_WICPixelFormat32bppPRGBA,
+    };
+    UINT i;
+
+    for (i = 0; i < ARRAY_SIZE(formats); i++)
+        if (IsEqualGUID(format, formats[i])) return TRUE;
+    return FALSE;
+}
+
 static HRESULT WINAPI BitmapScaler_CopyPixels(IWICBitmapScaler *iface,
     const WICRect *prc, UINT cbStride, UINT cbBufferSize, BYTE *pbBuffer)
 {
@@ -347,28 +550,70 @@ static HRESULT WINAPI BitmapScaler_Initialize(IWICBitmapScaler *iface,
         hr = get_pixelformat_bpp(&src_pixelformat, &This->bpp);
     }
 
+    if (SUCCEEDED(hr))
+    {
+        if ((This->bpp % 8) == 0)
+        {
+            IWICBitmapSource_AddRef(pISource);
+            This->source = pISource;
+        }
+        else
+        {
+            hr = WICConvertBitmapSource(&GUID_WICPixelFormat32bppBGRA,
+                pISource, &This->source);
+            This->bpp = 32;
+            src_pixelformat = GUID_WICPixelFormat32bppBGRA;
+        }
+    }
+
     if (SUCCEEDED(hr))
     {
         switch (mode)
         {
+        case WICBitmapInterpolationModeLinear:
+        case WICBitmapInterpolationModeCubic:
+        case WICBitmapInterpolationModeFant:
+            if (is_filterable_format(&src_pixelformat)) break;
+            FIXME("mode %i is not supported for format %s\n", mode, debugstr_guid(&src_pixelformat));
+            mode = WICBitmapInterpolationModeNearestNeighbor;
+            break;
         default:
             FIXME("unsupported mode %i\n", mode);
+            mode = WICBitmapInterpolationModeNearestNeighbor;
             /* fall-through */
         case WICBitmapInterpolationModeNearestNeighbor:
-            if ((This->bpp % 8) == 0)
+            break;
+        }
+
+        if (mode == WICBitmapInterpolationModeNearestNeighbor)
+        {
+            This->fn_get_required_source_rect = NearestNeighbor_GetRequiredSourceRect;
+            This->fn_copy_scanline = NearestNeighbor_CopyScanline;
+        }
+        else
+        {
+            hr = init_scaler_filter(&This->filter_x, This->src_width, This->width, mode);
+            if (SUCCEEDED(hr))
+                hr = init_scaler_filter(&This->filter_y, This->src_height, This->height, mode);
+            if (SUCCEEDED(hr) && !(This->filter_row = malloc(This->src_width * (This->bpp / 8) * sizeof(float))))
+                hr = E_OUTOFMEMORY;
+
+            if (FAILED(hr))
             {
-                IWICBitmapSource_AddRef(pISource);
-                This->source = pISource;
+                free_scaler_filter(&This->filter_x);
+                free_scaler_filter(&This->filter_y);
+                memset(&This->filter_x, 0, sizeof(This->filter_x));
+                memset(&This->filter_y, 0, sizeof(This->filter_y));
+                IWICBitmapSource_Release(This->source);
+                This->source = NULL;
             }
             else
             {
-                hr = WICConvertBitmapSource(&GUID_WICPixelFormat32bppBGRA,
-                    pISource, &This->source);
-                This->bpp = 32;
+                This->fn_get_required_source_rect = Filtered_GetRequiredSourceRect;
+                This->fn_copy_scanline = Filtered_CopyScanline;
+                This->straight_alpha = IsEqualGUID(&src_pixelformat, &GUID_WICPixelFormat32bppBGRA) ||
+                        IsEqualGUID(&src_pixelformat, &GUID_WICPixelFormat32bppRGBA);
             }
-            This->fn_get_required_source_rect = NearestNeighbor_GetRequiredSourceRect;
-            This->fn_copy_scanline = NearestNeighbor_CopyScanline;
-            break;
         }
     }
 
@@ -527,6 +772,10 @@ HRESULT BitmapScaler_Create(IWICBitmapScaler **scaler)
     This->src_height = 0;
     This->mode = 0;
     This->bpp = 0;
+    memset(&This->filter_x, 0, sizeof(This->filter_x));
+    memset(&This->filter_y, 0, sizeof(This->filter_y));
+    This->filter_row = NULL;
+    This->straight_alpha = FALSE;
     InitializeCriticalSectionEx(&This->lock, 0, RTL_CRITICAL_SECTION_FLAG_FORCE_DEBUG_INFO);
     This->lock.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": BitmapScaler.lock");
 
@@ -1318,6 +1318,114 @@ static void test_bitmap_scaler(void)
     IWICBitmap_Release(bitmap);
 }
 
+static void test_bitmap_scaler_interpolation(void)
+{
+    static const WICBitmapInterpolationMode modes[] =
+    {
+        WICBitmapInterpolationModeNearestNeighbor,
+        WICBitmapInterpolationModeLinear,
+        WICBitmapInterpolationModeCubic,
+        WICBitmapInterpolationModeFant,
+    };
+    static BYTE data[] =
+    {
+        0,   100, 50,  250,
+        200, 100, 150, 50,
+    };
+    static BYTE alpha_data[] =
+    {
+        0,   0, 255, 0,   /* transparent red */
+        255, 0, 0,   255, /* opaque blue */
+    };
+    IWICBitmapScaler *scaler;
+    IWICBitmap *bitmap;
+    BYTE buf[16], row[4];
+    WICRect rc;
+    HRESULT hr;
+    UINT i, y;
+
+    hr = IWICImagingFactory_CreateBitmapFromMemory(factory, 4, 2, &GUID_WICPixelFormat8bppGray,
+        4, sizeof(data), data, &bitmap);
+    ok(hr == S_OK, "Failed to create a bitmap, hr %#lx.\n", hr);
+
+    for (i = 0; i < ARRAY_SIZE(modes); i++)
+    {
+        winetest_push_context("mode %u", modes[i]);
+
+        hr = IWICImagingFactory_CreateBitmapScaler(factory, &scaler);
+        ok(hr == S_OK, "Failed to create bitmap scaler, hr %#lx.\n", hr);
+        hr = IWICBitmapScaler_Initialize(scaler, (IWICBitmapSource *)bitmap, 4, 4, modes[i]);
+        ok(hr == S_OK, "Failed to initialize bitmap scaler, hr %#lx.\n", hr);
+
+        memset(buf, 0xcc, sizeof(buf));
+        hr = IWICBitmapScaler_CopyPixels(scaler, NULL, 4, sizeof(buf), buf);
+        ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+
+        /* Copying one scanline at a time gives the same result. */
+        for (y = 0; y < 4; y++)
+        {
+            rc.X = 0;
+            rc.Y = y;
+            rc.Width = 4;
+            rc.Height = 1;
+            memset(row, 0xcc, sizeof(row));
+            hr = IWICBitmapScaler_CopyPixels(scaler, &rc, 4, sizeof(row), row);
+            ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+            ok(!memcmp(row, buf + y * 4, sizeof(row)), "Unexpected row %u.\n", y);
+        }
+
+        IWICBitmapScaler_Release(scaler);
+
+        hr = IWICImagingFactory_CreateBitmapScaler(factory, &scaler);
+        ok(hr == S_OK, "Failed to create bitmap scaler, hr %#lx.\n", hr);
+        hr = IWICBitmapScaler_Initialize(scaler, (IWICBitmapSource *)bitmap, 2, 1, modes[i]);
+        ok(hr == S_OK, "Failed to initialize bitmap scaler, hr %#lx.\n", hr);
+
+        memset(buf, 0xcc, sizeof(buf));
+        hr = IWICBitmapScaler_CopyPixels(scaler, NULL, 2, sizeof(buf), buf);
+        ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+        if (modes[i] == WICBitmapInterpolationModeNearestNeighbor)
+            ok(buf[0] == 0 && buf[1] == 50, "Unexpected data %u, %u.\n", buf[0], buf[1]);
+        else if (modes[i] != WICBitmapInterpolationModeCubic)
+        {
+            /* Both modes average each 2x2 block, the averages are exact. */
+            ok(buf[0] == 100 && buf[1] == 125, "Unexpected data %u, %u.\n", buf[0], buf[1]);
+        }
+
+        IWICBitmapScaler_Release(scaler);
+
+        winetest_pop_context();
+    }
+
+    IWICBitmap_Release(bitmap);
+
+    /* The color of a transparent pixel doesn't contribute to filtered pixels. */
+    hr = IWICImagingFactory_CreateBitmapFromMemory(factory, 2, 1, &GUID_WICPixelFormat32bppBGRA,
+        8, sizeof(alpha_data), alpha_data, &bitmap);
+    ok(hr == S_OK, "Failed to create a bitmap, hr %#lx.\n", hr);
+
+    for (i = 1; i < ARRAY_SIZE(modes); i++)
+    {
+        winetest_push_context("mode %u", modes[i]);
+
+        hr = IWICImagingFactory_CreateBitmapScaler(factory, &scaler);
+        ok(hr == S_OK, "Failed to create bitmap scaler, hr %#lx.\n", hr);
+        hr = IWICBitmapScaler_Initialize(scaler, (IWICBitmapSource *)bitmap, 1, 1, modes[i]);
+        ok(hr == S_OK, "Failed to initialize bitmap scaler, hr %#lx.\n", hr);
+
+        memset(buf, 0xcc, sizeof(buf));
+        hr = IWICBitmapScaler_CopyPixels(scaler, NULL, 4, sizeof(buf), buf);
+        ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+        ok(buf[0] == 255 && !buf[1] && !buf[2], "Unexpected color %u, %u, %u.\n", buf[0], buf[1], buf[2]);
+
+        IWICBitmapScaler_Release(scaler);
+
+        winetest_pop_context();
+    }
+
+    IWICBitmap_Release(bitmap);
+}
+
 static LONG obj_refcount(void *obj)
 {
     IUnknown_AddRef((IUnknown *)obj);
@@ -1494,6 +1602,7 @@ START_TEST(bitmap)
     test_CreateBitmapFromHBITMAP();
     test_clipper();
     test_bitmap_scaler();
+    test_bitmap_scaler_interpolation();
 
     IWICImagingFactory_Release(factory);
 
@@ -16,6 +16,8 @@
  * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
  */
 
+#include <stdio.h>
+
 #include "wined3d_private.h"
 #include "wined3d_vk.h"
 
@@ -411,6 +413,91 @@ static void get_physical_device_info(const struct wined3d_adapter_vk *adapter_vk
         VK_CALL(vkGetPhysicalDeviceFeatures(physical_device, &features2->features));
 }
 
+static void wined3d_device_vk_create_pipeline_cache(struct wined3d_device_vk *device_vk,
+        const struct wined3d_adapter_vk *adapter_vk)
+{
+    const struct wined3d_vk_info *vk_info = &device_vk->vk_info;
+    const VkPipelineCacheHeaderVersionOne *header;
+    VkPipelineCacheCreateInfo cache_info;
+    VkPhysicalDeviceProperties properties;
+    SIZE_T size = 0;
+    void *data = NULL;
+    char name[32];
+    VkResult vr;
+
+    device_vk->vk_pipeline_cache = VK_NULL_HANDLE;
+    if (!wined3d_settings.shader_cache)
+        return;
+
+    VK_CALL(vkGetPhysicalDeviceProperties(adapter_vk->physical_device, &properties));
+    sprintf(name, "vulkan-%04x-%04x.bin", properties.vendorID, properties.deviceID);
+    if (!wined3d_get_cache_file_path(name, device_vk->pipeline_cache_path, sizeof(device_vk->pipeline_cache_path)))
+        device_vk->pipeline_cache_path[0] = 0;
+    else if ((data = wined3d_load_cache_file(device_vk->pipeline_cache_path, &size)))
+    {
+        /* Drivers are supposed to ignore incompatible data, but don't rely on that. */
+        header = data;
+        if (size < sizeof(*header) || header->headerSize < sizeof(*header)
+                || header->headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+                || header->vendorID != properties.vendorID || header->deviceID != properties.deviceID
+                || memcmp(header->pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE))
+        {
+            TRACE("Discarding incompatible pipeline cache data.\n");
+            free(data);
+            data = NULL;
+            size = 0;
+        }
+    }
+
+    cache_info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    cache_info.pNext = NULL;
+    cache_info.flags = 0;
+    cache_info.initialDataSize = size;
+    cache_info.pInitialData = data;
+    if ((vr = VK_CALL(vkCreatePipelineCache(device_vk->vk_device, &cache_info,
+            NULL, &device_vk->vk_pipeline_cache))) < 0 && data)
+    {
+        WARN("Failed to create pipeline cache with initial data, vr %s.\n", wined3d_debug_vkresult(vr));
+        cache_info.initialDataSize = 0;
+        cache_info.pInitialData = NULL;
+        vr = VK_CALL(vkCreatePipelineCache(device_vk->vk_device, &cache_info, NULL, &device_vk->vk_pipeline_cache));
+    }
+    if (vr < 0)
+    {
+        WARN("Failed to create pipeline cache, vr %s.\n", wined3d_debug_vkresult(vr));
+        device_vk->vk_pipeline_cache = VK_NULL_HANDLE;
+    }
+    free(data);
+
+    TRACE("Created pipeline cache 0x%s from %Iu bytes of data.\n",
+            wine_dbgstr_longlong(device_vk->vk_pipeline_cache), size);
+}
+
+static void wined3d_device_vk_destroy_pipeline_cache(struct wined3d_device_vk *device_vk)
+{
+    const struct wined3d_vk_info *vk_info = &device_vk->vk_info;
+    void *data;
+    size_t size;
+    VkResult vr;
+
+    if (!device_vk->vk_pipeline_cache)
+        return;
+
+    if (device_vk->pipeline_cache_path[0]
+            && (vr = VK_CALL(vkGetPipelineCacheData(device_vk->vk_device, device_vk->vk_pipeline_cache,
+            &size, NULL))) >= 0 && size && (data = malloc(size)))
+    {
+        if ((vr = VK_CALL(vkGetPipelineCacheData(device_vk->vk_device, device_vk->vk_pipeline_cache,
+                &size, data))) >= 0)
+            wined3d_save_cache_file(device_vk->pipeline_cache_path, data, size);
+        else
+            WARN("Failed to get pipeline cache data, vr %s.\n", wined3d_debug_vkresult(vr));
+        free(data);
+    }
+
+    VK_CALL(vkDestroyPipelineCache(device_vk->vk_device, device_vk->vk_pipeline_cache, NULL));
+}
+
 static HRESULT adapter_vk_create_device(struct wined3d *wined3d, const struct wined3d_adapter *adapter,
         enum wined3d_device_type device_type, HWND focus_window, unsigned int flags, BYTE surface_alignment,
         const enum wined3d_feature_level *levels, unsigned int level_count,
@@ -486,10 +573,13 @@ static HRESULT adapter_vk_create_device(struct wined3d *wined3d, const struct wi
 #undef VK_DEVICE_EXT_PFN
 #undef VK_DEVICE_PFN
 
+    wined3d_device_vk_create_pipeline_cache(device_vk, adapter_vk);
+
     if (!wined3d_allocator_init(&device_vk->allocator,
             adapter_vk->memory_properties.memoryTypeCount, &wined3d_allocator_vk_ops))
     {
         WARN("Failed to initialise allocator.\n");
+        wined3d_device_vk_destroy_pipeline_cache(device_vk);
         hr = E_FAIL;
         goto fail;
     }
@@ -499,6 +589,7 @@ static HRESULT adapter_vk_create_device(struct wined3d *wined3d, const struct wi
     {
         WARN("Failed to initialize device, hr %#lx.\n", hr);
         wined3d_allocator_cleanup(&device_vk->allocator);
+        wined3d_device_vk_destroy_pipeline_cache(device_vk);
         goto fail;
     }
 
@@ -524,6 +615,7 @@ static void adapter_vk_destroy_device(struct wined3d_device *device)
 
     wined3d_lock_cleanup(&device_vk->allocator_cs);
 
+    wined3d_device_vk_destroy_pipeline_cache(device_vk);
     VK_CALL(vkDestroyDevice(device_vk->vk_device, NULL));
     free(device_vk);
 }
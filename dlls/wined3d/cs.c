@@ -52,7 +52,7 @@ struct wined3d_command_list
 
     struct wined3d_device *device;
 
-    SIZE_T data_size;
+    SIZE_T data_size, data_capacity;
     void *data;
 
     SIZE_T resource_count;
@@ -3590,6 +3590,7 @@ struct wined3d_cs *wined3d_cs_create(struct wined3d_device *device,
         ERR_(d3d_sync)("Forcing serialization of all command streams.\n");
 
     state_init(&cs->state, d3d_info, WINED3D_STATE_NO_REF | WINED3D_STATE_INIT_DEFAULT, cs->c.state->feature_level);
+    wined3d_lock_init(&cs->packet_buffer_lock, "wined3d_cs.packet_buffer_lock");
 
     cs->data_size = WINED3D_INITIAL_CS_SIZE;
     if (!(cs->data = malloc(cs->data_size)))
@@ -3657,6 +3658,7 @@ struct wined3d_cs *wined3d_cs_create(struct wined3d_device *device,
     return cs;
 
 fail:
+    wined3d_lock_cleanup(&cs->packet_buffer_lock);
     wined3d_state_destroy(cs->c.state);
     state_cleanup(&cs->state);
     free(cs);
@@ -3665,6 +3667,8 @@ fail:
 
 void wined3d_cs_destroy(struct wined3d_cs *cs)
 {
+    unsigned int i;
+
     if (cs->thread)
     {
         wined3d_cs_emit_stop(cs);
@@ -3675,6 +3679,10 @@ void wined3d_cs_destroy(struct wined3d_cs *cs)
             ERR("Closing event failed.\n");
     }
 
+    for (i = 0; i < cs->packet_buffer_count; ++i)
+        free(cs->packet_buffers[i].data);
+    wined3d_lock_cleanup(&cs->packet_buffer_lock);
+
     wined3d_state_destroy(cs->c.state);
     state_cleanup(&cs->state);
     free(cs->data);
@@ -4189,6 +4197,49 @@ struct wined3d_deferred_context
     struct wined3d_deferred_query_issue *queries;
 };
 
+/* Recording a command list hands the deferred context's packet buffer over to
+ * the command list. Large command lists are common in applications that
+ * record on several threads each frame, so rather than freeing the buffer
+ * when the command list is destroyed, keep a few around for the next
+ * recording, avoiding large allocations and copies on the recording
+ * threads. */
+static void wined3d_cs_get_packet_buffer(struct wined3d_cs *cs, void **data, SIZE_T *capacity)
+{
+    struct wined3d_cs_packet_buffer *buffer;
+
+    *data = NULL;
+    *capacity = 0;
+
+    EnterCriticalSection(&cs->packet_buffer_lock);
+    if (cs->packet_buffer_count)
+    {
+        buffer = &cs->packet_buffers[--cs->packet_buffer_count];
+        *data = buffer->data;
+        *capacity = buffer->capacity;
+    }
+    LeaveCriticalSection(&cs->packet_buffer_lock);
+}
+
+static void wined3d_cs_put_packet_buffer(struct wined3d_cs *cs, void *data, SIZE_T capacity)
+{
+    struct wined3d_cs_packet_buffer *buffer;
+
+    if (!data)
+        return;
+
+    EnterCriticalSection(&cs->packet_buffer_lock);
+    if (cs->packet_buffer_count < ARRAY_SIZE(cs->packet_buffers))
+    {
+        buffer = &cs->packet_buffers[cs->packet_buffer_count++];
+        buffer->data = data;
+        buffer->capacity = capacity;
+        data = NULL;
+    }
+    LeaveCriticalSection(&cs->packet_buffer_lock);
+
+    free(data);
+}
+
 static struct wined3d_deferred_context *wined3d_deferred_context_from_context(struct wined3d_device_context *context)
 {
     return CONTAINING_RECORD(context, struct wined3d_deferred_context, c);
@@ -4528,8 +4579,7 @@ HRESULT CDECL wined3d_deferred_context_record_command_list(struct wined3d_device
     memory = malloc(sizeof(*object) + deferred->resource_count * sizeof(*object->resources)
             + deferred->upload_count * sizeof(*object->uploads)
             + deferred->command_list_count * sizeof(*object->command_lists)
-            + deferred->query_count * sizeof(*object->queries)
-            + deferred->data_size);
+            + deferred->query_count * sizeof(*object->queries));
 
     if (!memory)
     {
@@ -4568,9 +4618,11 @@ HRESULT CDECL wined3d_deferred_context_record_command_list(struct wined3d_device
     memcpy(object->queries, deferred->queries, deferred->query_count * sizeof(*object->queries));
     /* Transfer our references to the queries to the command list. */
 
-    object->data = memory;
+    /* Transfer the packet buffer to the command list. */
+    object->data = deferred->data;
     object->data_size = deferred->data_size;
-    memcpy(object->data, deferred->data, deferred->data_size);
+    object->data_capacity = deferred->data_capacity;
+    wined3d_cs_get_packet_buffer(deferred->c.device->cs, &deferred->data, &deferred->data_capacity);
 
     deferred->data_size = 0;
     deferred->resource_count = 0;
@@ -4634,6 +4686,7 @@ static void wined3d_command_list_destroy_object(void *object)
         }
     }
 
+    wined3d_cs_put_packet_buffer(list->device->cs, list->data, list->data_capacity);
     free(list);
 }
 
@@ -634,6 +634,302 @@ void shader_glsl_validate_link(const struct wined3d_gl_info *gl_info, GLuint pro
     print_glsl_info_log(gl_info, program, TRUE);
 }
 
+#define WINED3D_GLSL_PROGRAM_BINARY_MAGIC 0x42504777 /* "wGPB" */
+#define WINED3D_GLSL_PROGRAM_BINARY_PATTERN "glsl-*.bin"
+#define WINED3D_GLSL_PROGRAM_BINARY_CACHE_SIZE (128 * 1024 * 1024)
+
+/* The header is followed by "key_size" bytes of key data, which is
+ * compared in full on load, and "binary_size" bytes of program binary. */
+struct glsl_program_binary_header
+{
+    uint32_t magic;
+    uint32_t format;
+    uint64_t key;
+    uint32_t key_size;
+    uint32_t binary_size;
+};
+
+struct glsl_program_binary_save
+{
+    char path[MAX_PATH];
+    HMODULE module;
+    SIZE_T size;
+    struct glsl_program_binary_header header;
+};
+
+struct glsl_attached_shader
+{
+    GLint type;
+    GLuint id;
+    GLint length;
+};
+
+static INIT_ONCE shader_glsl_program_binary_cache_once = INIT_ONCE_STATIC_INIT;
+static LONG64 shader_glsl_program_binary_cache_size;
+
+static BOOL WINAPI shader_glsl_init_program_binary_cache(INIT_ONCE *once, void *param, void **context)
+{
+    /* Evict the oldest programs once per process, and keep track of the
+     * size from there on, so that the cache doesn't grow without bound. */
+    shader_glsl_program_binary_cache_size = wined3d_trim_cache_files(WINED3D_GLSL_PROGRAM_BINARY_PATTERN,
+            WINED3D_GLSL_PROGRAM_BINARY_CACHE_SIZE * 3 / 4);
+    return TRUE;
+}
+
+static uint64_t shader_glsl_hash_data(uint64_t hash, const void *data, size_t size)
+{
+    const unsigned char *ptr = data;
+
+    /* 64-bit FNV-1a. */
+    while (size--)
+    {
+        hash ^= *ptr++;
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+static BOOL shader_glsl_use_program_binary_cache(const struct wined3d_gl_info *gl_info)
+{
+    if (!wined3d_settings.shader_cache || !gl_info->supported[ARB_GET_PROGRAM_BINARY])
+        return FALSE;
+
+    InitOnceExecuteOnce(&shader_glsl_program_binary_cache_once, shader_glsl_init_program_binary_cache, NULL, NULL);
+    return TRUE;
+}
+
+static int __cdecl glsl_attached_shader_compare(const void *a, const void *b)
+{
+    const struct glsl_attached_shader *s1 = a, *s2 = b;
+
+    return s1->type - s2->type;
+}
+
+/* Get the data that identifies a linked program: the driver strings, any
+ * extra state, and the type and source of each attached shader.
+ *
+ * Context activation is done by the caller. */
+static void *shader_glsl_get_program_key(const struct wined3d_gl_info *gl_info,
+        GLuint program, const void *extra, size_t extra_size, size_t *key_size)
+{
+    static const GLenum names[] = {GL_VENDOR, GL_RENDERER, GL_VERSION};
+    struct glsl_attached_shader *shaders;
+    const char *strings[ARRAY_SIZE(names)];
+    GLint i, shader_count;
+    GLuint *ids;
+    size_t size;
+    char *key, *ptr;
+
+    GL_EXTCALL(glGetProgramiv(program, GL_ATTACHED_SHADERS, &shader_count));
+    if (!(ids = calloc(shader_count, sizeof(*ids))))
+        return NULL;
+    if (!(shaders = calloc(shader_count, sizeof(*shaders))))
+    {
+        free(ids);
+        return NULL;
+    }
+    GL_EXTCALL(glGetAttachedShaders(program, shader_count, NULL, ids));
+
+    /* Program binaries are only valid for the exact driver build that
+     * produced them; drivers are free to reject anything else, but not all of
+     * them do so reliably. */
+    size = extra_size;
+    for (i = 0; i < ARRAY_SIZE(names); ++i)
+    {
+        if (!(strings[i] = (const char *)gl_info->gl_ops.gl.p_glGetString(names[i])))
+            strings[i] = "";
+        size += strlen(strings[i]) + 1;
+    }
+    for (i = 0; i < shader_count; ++i)
+    {
+        shaders[i].id = ids[i];
+        GL_EXTCALL(glGetShaderiv(ids[i], GL_SHADER_TYPE, &shaders[i].type));
+        GL_EXTCALL(glGetShaderiv(ids[i], GL_SHADER_SOURCE_LENGTH, &shaders[i].length));
+        size += sizeof(shaders[i].type) + sizeof(shaders[i].length) + shaders[i].length;
+    }
+    free(ids);
+
+    /* The order of attached shaders is implementation defined, but there's
+     * at most one shader per stage. */
+    qsort(shaders, shader_count, sizeof(*shaders), glsl_attached_shader_compare);
+
+    if ((key = ptr = malloc(size)))
+    {
+        for (i = 0; i < ARRAY_SIZE(names); ++i)
+        {
+            strcpy(ptr, strings[i]);
+            ptr += strlen(strings[i]) + 1;
+        }
+        if (extra_size)
+            memcpy(ptr, extra, extra_size);
+        ptr += extra_size;
+        for (i = 0; i < shader_count; ++i)
+        {
+            memcpy(ptr, &shaders[i].type, sizeof(shaders[i].type));
+            ptr += sizeof(shaders[i].type);
+            memcpy(ptr, &shaders[i].length, sizeof(shaders[i].length));
+            ptr += sizeof(shaders[i].length);
+            GL_EXTCALL(glGetShaderSource(shaders[i].id, shaders[i].length, NULL, ptr));
+            ptr += shaders[i].length;
+        }
+        *key_size = size;
+    }
+    free(shaders);
+    checkGLcall("get program key");
+
+    return key;
+}
+
+/* Context activation is done by the caller. */
+static BOOL shader_glsl_load_program_binary(const struct wined3d_gl_info *gl_info, GLuint program,
+        const char *path, uint64_t hash, const void *key, size_t key_size)
+{
+    const struct glsl_program_binary_header *header;
+    GLint status = GL_FALSE;
+    SIZE_T size;
+    void *data;
+
+    if (!(data = wined3d_load_cache_file(path, &size)))
+        return FALSE;
+
+    /* The file name is derived from a hash of the key, so compare the full
+     * key to rule out collisions. */
+    header = data;
+    if (size > sizeof(*header) && header->magic == WINED3D_GLSL_PROGRAM_BINARY_MAGIC
+            && header->key == hash && header->key_size == key_size
+            && header->binary_size && header->binary_size <= INT_MAX
+            && size - sizeof(*header) - key_size == header->binary_size
+            && !memcmp(header + 1, key, key_size))
+    {
+        GL_EXTCALL(glProgramBinary(program, header->format,
+                (const char *)(header + 1) + key_size, header->binary_size));
+        GL_EXTCALL(glGetProgramiv(program, GL_LINK_STATUS, &status));
+        /* A rejected binary is expected after driver updates; clear the
+         * error so that it doesn't show up in checkGLcall(). */
+        gl_info->gl_ops.gl.p_glGetError();
+    }
+    free(data);
+
+    TRACE("Program %u, binary %s, status %#x.\n", program, debugstr_a(path), status);
+    return status == GL_TRUE;
+}
+
+static void CALLBACK shader_glsl_save_program_binary_callback(TP_CALLBACK_INSTANCE *instance, void *context)
+{
+    struct glsl_program_binary_save *save = context;
+    HMODULE module = save->module;
+
+    wined3d_save_cache_file(save->path, &save->header, save->size);
+    free(save);
+    FreeLibraryWhenCallbackReturns(instance, module);
+}
+
+/* Context activation is done by the caller. */
+static void shader_glsl_save_program_binary(const struct wined3d_gl_info *gl_info, GLuint program,
+        const char *path, uint64_t hash, const void *key, size_t key_size)
+{
+    struct glsl_program_binary_save *save;
+    GLint status, length = 0;
+    GLenum format;
+    SIZE_T size;
+    char *binary;
+
+    GL_EXTCALL(glGetProgramiv(program, GL_LINK_STATUS, &status));
+    if (status != GL_TRUE)
+        return;
+    GL_EXTCALL(glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length));
+    if (length <= 0)
+        return;
+
+    size = sizeof(save->header) + key_size + length;
+    if (InterlockedExchangeAdd64(&shader_glsl_program_binary_cache_size, size) + size
+            > WINED3D_GLSL_PROGRAM_BINARY_CACHE_SIZE)
+    {
+        TRACE("Program binary cache is full, not saving program %u.\n", program);
+        InterlockedExchangeAdd64(&shader_glsl_program_binary_cache_size, -(LONG64)size);
+        return;
+    }
+
+    if (!(save = malloc(offsetof(struct glsl_program_binary_save, header) + size)))
+        return;
+    binary = (char *)(&save->header + 1) + key_size;
+    GL_EXTCALL(glGetProgramBinary(program, length, &length, &format, binary));
+    checkGLcall("glGetProgramBinary");
+    if (length <= 0)
+    {
+        free(save);
+        return;
+    }
+
+    strcpy(save->path, path);
+    save->module = NULL;
+    save->size = sizeof(save->header) + key_size + length;
+    save->header.magic = WINED3D_GLSL_PROGRAM_BINARY_MAGIC;
+    save->header.format = format;
+    save->header.key = hash;
+    save->header.key_size = key_size;
+    save->header.binary_size = length;
+    memcpy(&save->header + 1, key, key_size);
+
+    /* Writing the file can take a while, so don't do it on the rendering
+     * thread. The callback holds a reference to wined3d. */
+    if (GetModuleHandleExA(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS, (const char *)shader_glsl_save_program_binary,
+            &save->module) && TrySubmitThreadpoolCallback(shader_glsl_save_program_binary_callback, save, NULL))
+        return;
+
+    if (save->module)
+        FreeLibrary(save->module);
+    wined3d_save_cache_file(save->path, &save->header, save->size);
+    free(save);
+}
+
+/* Link a program with its shaders and attribute bindings already set up.
+ * "extra" holds any additional state that affects linking, but isn't
+ * part of the shader sources. If program binaries are available the linked
+ * program is looked up in, and stored to, the on-disk shader cache.
+ *
+ * Context activation is done by the caller. */
+static void shader_glsl_link_program(const struct wined3d_gl_info *gl_info,
+        GLuint program, const void *extra, size_t extra_size)
+{
+    char name[32], path[MAX_PATH];
+    void *key = NULL;
+    size_t key_size;
+    uint64_t hash;
+
+    if (shader_glsl_use_program_binary_cache(gl_info)
+            && (key = shader_glsl_get_program_key(gl_info, program, extra, extra_size, &key_size)))
+    {
+        hash = shader_glsl_hash_data(0xcbf29ce484222325ull, key, key_size);
+        sprintf(name, "glsl-%08x%08x.bin", (unsigned int)(hash >> 32), (unsigned int)hash);
+        if (!wined3d_get_cache_file_path(name, path, sizeof(path)))
+        {
+            WARN("Failed to get path for program binary %s.\n", debugstr_a(name));
+            free(key);
+            key = NULL;
+        }
+        else if (shader_glsl_load_program_binary(gl_info, program, path, hash, key, key_size))
+        {
+            free(key);
+            return;
+        }
+        else
+        {
+            GL_EXTCALL(glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE));
+        }
+    }
+
+    TRACE("Linking GLSL shader program %u.\n", program);
+    GL_EXTCALL(glLinkProgram(program));
+    shader_glsl_validate_link(gl_info, program);
+
+    if (key)
+    {
+        shader_glsl_save_program_binary(gl_info, program, path, hash, key, key_size);
+        free(key);
+    }
+}
+
 static BOOL shader_glsl_use_layout_qualifier(const struct wined3d_gl_info *gl_info)
 {
     /* Layout qualifiers were introduced in GLSL 1.40. The Nvidia Legacy GPU
@@ -10289,9 +10585,7 @@ static HRESULT shader_glsl_compile_compute_shader(struct shader_glsl_priv *priv,
 
     list_add_head(&shader->linked_programs, &entry->cs.shader_entry);
 
-    TRACE("Linking GLSL shader program %u.\n", program_id);
-    GL_EXTCALL(glLinkProgram(program_id));
-    shader_glsl_validate_link(gl_info, program_id);
+    shader_glsl_link_program(gl_info, program_id, NULL, 0);
 
     GL_EXTCALL(glUseProgram(program_id));
     checkGLcall("glUseProgram");
@@ -10620,9 +10914,20 @@ static void set_glsl_shader_program(const struct wined3d_context_gl *context_gl,
     }
 
     /* Link the program */
-    TRACE("Linking GLSL shader program %u.\n", program_id);
-    GL_EXTCALL(glLinkProgram(program_id));
-    shader_glsl_validate_link(gl_info, program_id);
+    if (gshader && gshader->u.gs.so_desc)
+    {
+        /* The transform feedback varyings aren't part of the shader sources,
+         * so don't try to use the shader cache for these. */
+        TRACE("Linking GLSL shader program %u.\n", program_id);
+        GL_EXTCALL(glLinkProgram(program_id));
+        shader_glsl_validate_link(gl_info, program_id);
+    }
+    else
+    {
+        BOOL dual_source = state->blend_state && state->blend_state->dual_source;
+
+        shader_glsl_link_program(gl_info, program_id, &dual_source, sizeof(dual_source));
+    }
 
     shader_glsl_init_vs_uniform_locations(gl_info, priv, program_id, &entry->vs,
             vshader ? vshader->limits->constant_float : 0);
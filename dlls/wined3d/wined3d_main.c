@@ -22,6 +22,8 @@
  * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
  */
 
+#include <stdio.h>
+
 #define VKD3D_NO_VULKAN_H
 #define VKD3D_NO_WIN32_TYPES
 #include "initguid.h"
@@ -130,6 +132,7 @@ struct wined3d_settings wined3d_settings =
     .max_sm_cs = UINT_MAX,
     .renderer = WINED3D_RENDERER_AUTO,
     .shader_backend = WINED3D_SHADER_BACKEND_AUTO,
+    .shader_cache = TRUE,
 };
 
 enum wined3d_renderer CDECL wined3d_get_renderer(void)
@@ -263,6 +266,176 @@ BOOL wined3d_get_app_name(char *app_name, unsigned int app_name_size)
     return TRUE;
 }
 
+static char wined3d_cache_dir[MAX_PATH];
+static INIT_ONCE wined3d_cache_dir_once = INIT_ONCE_STATIC_INIT;
+
+/* Create the per-application cache directory,
+ * %LOCALAPPDATA%\wine\wined3d\<application>. */
+static BOOL WINAPI wined3d_init_cache_dir(INIT_ONCE *once, void *param, void **context)
+{
+    char app_name[MAX_PATH], path[MAX_PATH];
+    unsigned int len;
+    char *p;
+
+    if (!wined3d_get_app_name(app_name, ARRAY_SIZE(app_name)))
+        return TRUE;
+    len = GetEnvironmentVariableA("LOCALAPPDATA", path, ARRAY_SIZE(path));
+    if (!len || len >= ARRAY_SIZE(path))
+        return TRUE;
+    if (len + strlen("\\wine\\wined3d\\") + strlen(app_name) >= ARRAY_SIZE(path))
+        return TRUE;
+
+    strcat(path, "\\wine\\wined3d\\");
+    strcat(path, app_name);
+    for (p = path + len + 1; (p = strchr(p, '\\')); ++p)
+    {
+        *p = 0;
+        CreateDirectoryA(path, NULL);
+        *p = '\\';
+    }
+    if (!CreateDirectoryA(path, NULL) && GetLastError() != ERROR_ALREADY_EXISTS)
+    {
+        WARN("Failed to create cache directory %s, error %lu.\n", debugstr_a(path), GetLastError());
+        return TRUE;
+    }
+
+    TRACE("Using cache directory %s.\n", debugstr_a(path));
+    strcpy(wined3d_cache_dir, path);
+    return TRUE;
+}
+
+/* Get the path of a file in the per-application cache directory. */
+BOOL wined3d_get_cache_file_path(const char *name, char *path, unsigned int path_size)
+{
+    InitOnceExecuteOnce(&wined3d_cache_dir_once, wined3d_init_cache_dir, NULL, NULL);
+    if (!wined3d_cache_dir[0])
+        return FALSE;
+    if (strlen(wined3d_cache_dir) + 1 + strlen(name) >= path_size)
+        return FALSE;
+
+    sprintf(path, "%s\\%s", wined3d_cache_dir, name);
+    return TRUE;
+}
+
+struct wined3d_cache_file
+{
+    FILETIME time;
+    ULONGLONG size;
+    char name[MAX_PATH];
+};
+
+static int __cdecl wined3d_cache_file_compare(const void *a, const void *b)
+{
+    const struct wined3d_cache_file *f1 = a, *f2 = b;
+
+    return CompareFileTime(&f1->time, &f2->time);
+}
+
+/* Delete the least recently written files matching "pattern" from the cache
+ * directory, until the total size of the remaining ones is at most
+ * "max_size". Returns the total size of the remaining files. */
+ULONGLONG wined3d_trim_cache_files(const char *pattern, ULONGLONG max_size)
+{
+    struct wined3d_cache_file *files = NULL;
+    SIZE_T count = 0, capacity = 0, i;
+    char path[MAX_PATH];
+    WIN32_FIND_DATAA data;
+    ULONGLONG total = 0;
+    HANDLE find;
+
+    if (!wined3d_get_cache_file_path(pattern, path, sizeof(path)))
+        return 0;
+    if ((find = FindFirstFileA(path, &data)) == INVALID_HANDLE_VALUE)
+        return 0;
+    do
+    {
+        if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+            continue;
+        if (!wined3d_array_reserve((void **)&files, &capacity, count + 1, sizeof(*files)))
+            break;
+        files[count].time = data.ftLastWriteTime;
+        files[count].size = ((ULONGLONG)data.nFileSizeHigh << 32) | data.nFileSizeLow;
+        strcpy(files[count].name, data.cFileName);
+        total += files[count++].size;
+    } while (FindNextFileA(find, &data));
+    FindClose(find);
+
+    if (total > max_size)
+    {
+        qsort(files, count, sizeof(*files), wined3d_cache_file_compare);
+        for (i = 0; i < count && total > max_size; ++i)
+        {
+            if (wined3d_get_cache_file_path(files[i].name, path, sizeof(path)) && DeleteFileA(path))
+                total -= files[i].size;
+        }
+        TRACE("Trimmed %s cache files to %s bytes.\n", debugstr_a(pattern), wine_dbgstr_longlong(total));
+    }
+    free(files);
+
+    return total;
+}
+
+void *wined3d_load_cache_file(const char *path, SIZE_T *size)
+{
+    LARGE_INTEGER file_size;
+    void *data = NULL;
+    DWORD read;
+    HANDLE file;
+
+    if ((file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL,
+            OPEN_EXISTING, 0, NULL)) == INVALID_HANDLE_VALUE)
+        return NULL;
+
+    if (GetFileSizeEx(file, &file_size) && file_size.QuadPart && file_size.QuadPart <= 256 * 1024 * 1024
+            && (data = malloc(file_size.QuadPart)))
+    {
+        if (ReadFile(file, data, file_size.QuadPart, &read, NULL) && read == file_size.QuadPart)
+        {
+            *size = read;
+        }
+        else
+        {
+            free(data);
+            data = NULL;
+        }
+    }
+    CloseHandle(file);
+
+    TRACE("Loaded %s, data %p.\n", debugstr_a(path), data);
+    return data;
+}
+
+BOOL wined3d_save_cache_file(const char *path, const void *data, SIZE_T size)
+{
+    char tmp_path[MAX_PATH];
+    DWORD written;
+    HANDLE file;
+    BOOL ret;
+
+    /* Write to a temporary file first, so that concurrent readers never see partial data. */
+    if (strlen(path) + 5 > ARRAY_SIZE(tmp_path))
+        return FALSE;
+    sprintf(tmp_path, "%s.tmp", path);
+
+    if ((file = CreateFileA(tmp_path, GENERIC_WRITE, 0, NULL,
+            CREATE_ALWAYS, 0, NULL)) == INVALID_HANDLE_VALUE)
+    {
+        WARN("Failed to create %s, error %lu.\n", debugstr_a(tmp_path), GetLastError());
+        return FALSE;
+    }
+    ret = WriteFile(file, data, size, &written, NULL) && written == size;
+    CloseHandle(file);
+
+    if (ret)
+        ret = MoveFileExA(tmp_path, path, MOVEFILE_REPLACE_EXISTING);
+    if (!ret)
+    {
+        WARN("Failed to write %s, error %lu.\n", debugstr_a(path), GetLastError());
+        DeleteFileA(tmp_path);
+    }
+    return ret;
+}
+
 static void vkd3d_log_callback(const char *fmt, va_list args)
 {
     char buffer[1024];
@@ -456,6 +629,8 @@ static BOOL wined3d_dll_init(HINSTANCE hInstDLL)
                 wined3d_settings.renderer = WINED3D_RENDERER_NO3D;
             }
         }
+        if (!get_config_key_dword(hkey, appkey, env, "ShaderCache", &wined3d_settings.shader_cache))
+            TRACE("Setting shader cache to %#x.\n", wined3d_settings.shader_cache);
         if (!get_config_key_dword(hkey, appkey, env, "cb_access_map_w", &tmpvalue) && tmpvalue)
         {
             TRACE("Forcing all constant buffers to be write-mappable.\n");
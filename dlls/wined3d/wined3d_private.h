@@ -497,6 +497,7 @@ struct wined3d_settings
     enum wined3d_renderer renderer;
     enum wined3d_shader_backend shader_backend;
     BOOL cb_access_map_w;
+    unsigned int shader_cache;
 };
 
 extern struct wined3d_settings wined3d_settings;
@@ -2804,6 +2805,10 @@ HRESULT wined3d_init(struct wined3d *wined3d, uint32_t flags);
 void wined3d_unregister_window(HWND window);
 
 BOOL wined3d_get_app_name(char *app_name, unsigned int app_name_size);
+BOOL wined3d_get_cache_file_path(const char *name, char *path, unsigned int path_size);
+void *wined3d_load_cache_file(const char *path, SIZE_T *size);
+ULONGLONG wined3d_trim_cache_files(const char *pattern, ULONGLONG max_size);
+BOOL wined3d_save_cache_file(const char *path, const void *data, SIZE_T size);
 
 enum wined3d_push_constants
 {
@@ -3587,6 +3592,7 @@ enum wined3d_cs_queue_id
 /* How long to wait for the CS from the client thread, in µs. */
 #define WINED3D_CS_CLIENT_WAIT_TIMEOUT  0
 #define WINED3D_CS_QUEUE_MASK           (WINED3D_CS_QUEUE_SIZE - 1)
+#define WINED3D_CS_PACKET_BUFFER_COUNT  4u
 
 C_ASSERT(!(WINED3D_CS_QUEUE_SIZE & (WINED3D_CS_QUEUE_SIZE - 1)));
 
@@ -3635,6 +3641,15 @@ struct wined3d_cs
     struct list query_poll_list;
     BOOL queries_flushed;
 
+    /* Packet buffers of destroyed command lists, for reuse by deferred contexts. */
+    CRITICAL_SECTION packet_buffer_lock;
+    struct wined3d_cs_packet_buffer
+    {
+        void *data;
+        SIZE_T capacity;
+    } packet_buffers[WINED3D_CS_PACKET_BUFFER_COUNT];
+    unsigned int packet_buffer_count;
+
     HANDLE event, present_event;
     LONG waiting_for_event;
     LONG waiting_for_present;
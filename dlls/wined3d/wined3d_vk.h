@@ -830,6 +830,9 @@ struct wined3d_device_vk
     struct wined3d_allocator allocator;
 
     struct wined3d_uav_clear_state_vk uav_clear_state;
+
+    VkPipelineCache vk_pipeline_cache;
+    char pipeline_cache_path[MAX_PATH];
 };
 
 static inline struct wined3d_device_vk *wined3d_device_vk(struct wined3d_device *device)
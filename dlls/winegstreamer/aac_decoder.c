@@ -77,7 +77,10 @@ static HRESULT try_create_wg_transform(struct aac_decoder *decoder)
     struct wg_transform_attrs attrs = {0};
 
     if (decoder->wg_transform)
+    {
         wg_transform_destroy(decoder->wg_transform);
+        wg_sample_queue_flush(decoder->wg_sample_queue, true);
+    }
     decoder->wg_transform = 0;
 
     mf_media_type_to_wg_format(decoder->input_type, &input_format);
@@ -456,17 +459,15 @@ static HRESULT WINAPI transform_GetOutputCurrentType(IMFTransform *iface, DWORD
 static HRESULT WINAPI transform_GetInputStatus(IMFTransform *iface, DWORD id, DWORD *flags)
 {
     struct aac_decoder *decoder = impl_from_IMFTransform(iface);
-    bool accepts_input;
 
     TRACE("iface %p, id %#lx, flags %p.\n", iface, id, flags);
 
     if (!decoder->wg_transform)
         return MF_E_TRANSFORM_TYPE_NOT_SET;
 
-    if (!wg_transform_get_status(decoder->wg_transform, &accepts_input))
-        return E_FAIL;
-
-    *flags = accepts_input ? MFT_INPUT_STATUS_ACCEPT_DATA : 0;
+    /* The input queue only changes when pushing or reading data, which both
+     * return the updated status, so there's no need to query it again. */
+    *flags = wg_sample_queue_accepts_input(decoder->wg_sample_queue) ? MFT_INPUT_STATUS_ACCEPT_DATA : 0;
     return S_OK;
 }
 
@@ -529,7 +530,7 @@ static HRESULT WINAPI transform_ProcessOutput(IMFTransform *iface, DWORD flags,
         return hr;
 
     if (SUCCEEDED(hr = wg_transform_read_mf(decoder->wg_transform, samples->pSample,
-            info.cbSize, NULL, &samples->dwStatus)))
+            info.cbSize, NULL, &samples->dwStatus, decoder->wg_sample_queue)))
         wg_sample_queue_flush(decoder->wg_sample_queue, false);
     else
         samples->dwStatus = MFT_OUTPUT_DATA_BUFFER_NO_SAMPLE;
@@ -48,6 +48,7 @@ struct wg_sample_queue;
 HRESULT wg_sample_queue_create(struct wg_sample_queue **out);
 void wg_sample_queue_destroy(struct wg_sample_queue *queue);
 void wg_sample_queue_flush(struct wg_sample_queue *queue, bool all);
+bool wg_sample_queue_accepts_input(struct wg_sample_queue *queue);
 
 wg_parser_t wg_parser_create(bool output_compressed);
 void wg_parser_destroy(wg_parser_t parser);
@@ -85,11 +86,9 @@ wg_transform_t wg_transform_create(const struct wg_format *input_format,
         const struct wg_format *output_format, const struct wg_transform_attrs *attrs);
 void wg_transform_destroy(wg_transform_t transform);
 bool wg_transform_set_output_format(wg_transform_t transform, struct wg_format *format);
-bool wg_transform_get_status(wg_transform_t transform, bool *accepts_input);
-HRESULT wg_transform_drain(wg_transform_t transform);
-HRESULT wg_transform_flush(wg_transform_t transform);
 void wg_transform_notify_qos(wg_transform_t transform,
         bool underflow, double proportion, int64_t diff, uint64_t timestamp);
+bool wg_transform_get_stats(wg_transform_t transform, struct wg_transform_stats *stats);
 
 HRESULT wg_muxer_create(const char *format, wg_muxer_t *muxer);
 void wg_muxer_destroy(wg_muxer_t muxer);
@@ -139,9 +138,13 @@ HRESULT wg_transform_push_quartz(wg_transform_t transform, struct wg_sample *sam
 HRESULT wg_transform_push_dmo(wg_transform_t transform, IMediaBuffer *media_buffer,
         DWORD flags, REFERENCE_TIME time_stamp, REFERENCE_TIME time_length, struct wg_sample_queue *queue);
 HRESULT wg_transform_read_mf(wg_transform_t transform, IMFSample *sample,
-        DWORD sample_size, struct wg_format *format, DWORD *flags);
-HRESULT wg_transform_read_quartz(wg_transform_t transform, struct wg_sample *sample);
-HRESULT wg_transform_read_dmo(wg_transform_t transform, DMO_OUTPUT_DATA_BUFFER *buffer);
+        DWORD sample_size, struct wg_format *format, DWORD *flags, struct wg_sample_queue *queue);
+HRESULT wg_transform_read_quartz(wg_transform_t transform, struct wg_sample *sample,
+        struct wg_sample_queue *queue);
+HRESULT wg_transform_read_dmo(wg_transform_t transform, DMO_OUTPUT_DATA_BUFFER *buffer,
+        struct wg_sample_queue *queue);
+HRESULT wg_transform_drain(wg_transform_t transform, struct wg_sample_queue *queue);
+HRESULT wg_transform_flush(wg_transform_t transform, struct wg_sample_queue *queue);
 
 HRESULT gstreamer_byte_stream_handler_create(REFIID riid, void **obj);
 
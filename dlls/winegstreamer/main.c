@@ -358,12 +358,17 @@ wg_transform_t wg_transform_create(const struct wg_format *input_format,
 
 void wg_transform_destroy(wg_transform_t transform)
 {
+    struct wg_transform_stats stats;
+
     TRACE("transform %#I64x.\n", transform);
 
+    if (TRACE_ON(quartz) && wg_transform_get_stats(transform, &stats))
+        TRACE("Output zero-copy %I64u bytes, copied %I64u bytes.\n", stats.zero_copy_bytes, stats.copied_bytes);
+
     WINE_UNIX_CALL(unix_wg_transform_destroy, &transform);
 }
 
-HRESULT wg_transform_push_data(wg_transform_t transform, struct wg_sample *sample)
+HRESULT wg_transform_push_data(wg_transform_t transform, struct wg_sample *sample, bool *accepts_input)
 {
     struct wg_transform_push_data_params params =
     {
@@ -372,16 +377,17 @@ HRESULT wg_transform_push_data(wg_transform_t transform, struct wg_sample *sampl
     };
     NTSTATUS status;
 
-    TRACE("transform %#I64x, sample %p.\n", transform, sample);
+    TRACE("transform %#I64x, sample %p, accepts_input %p.\n", transform, sample, accepts_input);
 
     if ((status = WINE_UNIX_CALL(unix_wg_transform_push_data, &params)))
         return HRESULT_FROM_NT(status);
 
+    *accepts_input = params.accepts_input;
     return params.result;
 }
 
 HRESULT wg_transform_read_data(wg_transform_t transform, struct wg_sample *sample,
-        struct wg_format *format)
+        struct wg_format *format, bool *accepts_input)
 {
     struct wg_transform_read_data_params params =
     {
@@ -391,28 +397,13 @@ HRESULT wg_transform_read_data(wg_transform_t transform, struct wg_sample *sampl
     };
     NTSTATUS status;
 
-    TRACE("transform %#I64x, sample %p, format %p.\n", transform, sample, format);
+    TRACE("transform %#I64x, sample %p, format %p, accepts_input %p.\n", transform, sample, format, accepts_input);
 
     if ((status = WINE_UNIX_CALL(unix_wg_transform_read_data, &params)))
         return HRESULT_FROM_NT(status);
 
-    return params.result;
-}
-
-bool wg_transform_get_status(wg_transform_t transform, bool *accepts_input)
-{
-    struct wg_transform_get_status_params params =
-    {
-        .transform = transform,
-    };
-
-    TRACE("transform %#I64x, accepts_input %p.\n", transform, accepts_input);
-
-    if (WINE_UNIX_CALL(unix_wg_transform_get_status, &params))
-        return false;
-
     *accepts_input = params.accepts_input;
-    return true;
+    return params.result;
 }
 
 bool wg_transform_set_output_format(wg_transform_t transform, struct wg_format *format)
@@ -428,7 +419,7 @@ bool wg_transform_set_output_format(wg_transform_t transform, struct wg_format *
     return !WINE_UNIX_CALL(unix_wg_transform_set_output_format, &params);
 }
 
-HRESULT wg_transform_drain(wg_transform_t transform)
+HRESULT wg_transform_drain_data(wg_transform_t transform)
 {
     NTSTATUS status;
 
@@ -443,7 +434,7 @@ HRESULT wg_transform_drain(wg_transform_t transform)
     return S_OK;
 }
 
-HRESULT wg_transform_flush(wg_transform_t transform)
+HRESULT wg_transform_flush_data(wg_transform_t transform)
 {
     NTSTATUS status;
 
@@ -476,6 +467,22 @@ void wg_transform_notify_qos(wg_transform_t transform,
     WINE_UNIX_CALL(unix_wg_transform_notify_qos, &params);
 }
 
+bool wg_transform_get_stats(wg_transform_t transform, struct wg_transform_stats *stats)
+{
+    struct wg_transform_get_stats_params params =
+    {
+        .transform = transform,
+    };
+
+    TRACE("transform %#I64x, stats %p.\n", transform, stats);
+
+    if (WINE_UNIX_CALL(unix_wg_transform_get_stats, &params))
+        return false;
+
+    *stats = params.stats;
+    return true;
+}
+
 HRESULT wg_muxer_create(const char *format, wg_muxer_t *muxer)
 {
     struct wg_muxer_create_params params =
@@ -343,7 +343,7 @@ static HRESULT WINAPI transform_sink_receive(struct strmbase_sink *pin, IMediaSa
             return hr;
         }
 
-        hr = wg_transform_read_quartz(filter->transform, wg_sample);
+        hr = wg_transform_read_quartz(filter->transform, wg_sample, filter->sample_queue);
         wg_sample_release(wg_sample);
 
         if (hr == MF_E_TRANSFORM_NEED_MORE_INPUT)
@@ -59,10 +59,10 @@ extern NTSTATUS wg_transform_destroy(void *args);
 extern NTSTATUS wg_transform_set_output_format(void *args);
 extern NTSTATUS wg_transform_push_data(void *args);
 extern NTSTATUS wg_transform_read_data(void *args);
-extern NTSTATUS wg_transform_get_status(void *args);
 extern NTSTATUS wg_transform_drain(void *args);
 extern NTSTATUS wg_transform_flush(void *args);
 extern NTSTATUS wg_transform_notify_qos(void *args);
+extern NTSTATUS wg_transform_get_stats(void *args);
 
 /* wg_muxer.c */
 
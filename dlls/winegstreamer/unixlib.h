@@ -343,6 +343,7 @@ struct wg_transform_push_data_params
     wg_transform_t transform;
     struct wg_sample *sample;
     HRESULT result;
+    UINT32 accepts_input;
 };
 
 struct wg_transform_read_data_params
@@ -351,6 +352,7 @@ struct wg_transform_read_data_params
     struct wg_sample *sample;
     struct wg_format *format;
     HRESULT result;
+    UINT32 accepts_input;
 };
 
 struct wg_transform_set_output_format_params
@@ -359,10 +361,16 @@ struct wg_transform_set_output_format_params
     const struct wg_format *format;
 };
 
-struct wg_transform_get_status_params
+struct wg_transform_stats
+{
+    UINT64 zero_copy_bytes; /* output bytes written directly into the sample memory */
+    UINT64 copied_bytes;    /* output bytes which had to be copied into the sample memory */
+};
+
+struct wg_transform_get_stats_params
 {
     wg_transform_t transform;
-    UINT32 accepts_input;
+    struct wg_transform_stats stats;
 };
 
 struct wg_transform_notify_qos_params
@@ -438,10 +446,10 @@ enum unix_funcs
 
     unix_wg_transform_push_data,
     unix_wg_transform_read_data,
-    unix_wg_transform_get_status,
     unix_wg_transform_drain,
     unix_wg_transform_flush,
     unix_wg_transform_notify_qos,
+    unix_wg_transform_get_stats,
 
     unix_wg_muxer_create,
     unix_wg_muxer_destroy,
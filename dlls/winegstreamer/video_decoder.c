@@ -612,10 +612,10 @@ static HRESULT WINAPI transform_ProcessMessage(IMFTransform *iface, MFT_MESSAGE_
         return S_OK;
 
     case MFT_MESSAGE_COMMAND_DRAIN:
-        return wg_transform_drain(decoder->wg_transform);
+        return wg_transform_drain(decoder->wg_transform, decoder->wg_sample_queue);
 
     case MFT_MESSAGE_COMMAND_FLUSH:
-        return wg_transform_flush(decoder->wg_transform);
+        return wg_transform_flush(decoder->wg_transform, decoder->wg_sample_queue);
 
     default:
         FIXME("Ignoring message %#x.\n", message);
@@ -742,7 +742,7 @@ static HRESULT WINAPI transform_ProcessOutput(IMFTransform *iface, DWORD flags,
     }
 
     if (SUCCEEDED(hr = wg_transform_read_mf(decoder->wg_transform, sample,
-            sample_size, &wg_format, &samples->dwStatus)))
+            sample_size, &wg_format, &samples->dwStatus, decoder->wg_sample_queue)))
     {
         wg_sample_queue_flush(decoder->wg_sample_queue, false);
 
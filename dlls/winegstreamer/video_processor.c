@@ -545,7 +545,7 @@ static HRESULT WINAPI video_processor_ProcessOutput(IMFTransform *iface, DWORD f
         return hr;
 
     if (SUCCEEDED(hr = wg_transform_read_mf(impl->wg_transform, samples->pSample,
-            info.cbSize, NULL, &samples->dwStatus)))
+            info.cbSize, NULL, &samples->dwStatus, impl->wg_sample_queue)))
         wg_sample_queue_flush(impl->wg_sample_queue, false);
 
     return hr;
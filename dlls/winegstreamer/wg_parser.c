@@ -1859,10 +1859,10 @@ const unixlib_entry_t __wine_unix_call_funcs[] =
 
     X(wg_transform_push_data),
     X(wg_transform_read_data),
-    X(wg_transform_get_status),
     X(wg_transform_drain),
     X(wg_transform_flush),
     X(wg_transform_notify_qos),
+    X(wg_transform_get_stats),
 
     X(wg_muxer_create),
     X(wg_muxer_destroy),
@@ -2044,6 +2044,7 @@ NTSTATUS wow64_wg_transform_push_data(void *args)
         wg_transform_t transform;
         PTR32 sample;
         HRESULT result;
+        UINT32 accepts_input;
     } *params32 = args;
     struct wg_transform_push_data_params params =
     {
@@ -2054,6 +2055,7 @@ NTSTATUS wow64_wg_transform_push_data(void *args)
 
     ret = wg_transform_push_data(&params);
     params32->result = params.result;
+    params32->accepts_input = params.accepts_input;
     return ret;
 }
 
@@ -2065,6 +2067,7 @@ NTSTATUS wow64_wg_transform_read_data(void *args)
         PTR32 sample;
         PTR32 format;
         HRESULT result;
+        UINT32 accepts_input;
     } *params32 = args;
     struct wg_transform_read_data_params params =
     {
@@ -2076,6 +2079,7 @@ NTSTATUS wow64_wg_transform_read_data(void *args)
 
     ret = wg_transform_read_data(&params);
     params32->result = params.result;
+    params32->accepts_input = params.accepts_input;
     return ret;
 }
 
@@ -2192,10 +2196,10 @@ const unixlib_entry_t __wine_unix_call_wow64_funcs[] =
 
     X64(wg_transform_push_data),
     X64(wg_transform_read_data),
-    X(wg_transform_get_status),
     X(wg_transform_drain),
     X(wg_transform_flush),
     X(wg_transform_notify_qos),
+    X(wg_transform_get_stats),
 
     X64(wg_muxer_create),
     X(wg_muxer_destroy),
@@ -32,6 +32,10 @@ struct wg_sample_queue
 {
     CRITICAL_SECTION cs;
     struct list samples;
+
+    /* Whether the transform accepts input, as of the last call that changed
+     * its input queue. Updated with cs held across that call. */
+    bool accepts_input;
 };
 
 struct wg_sample_ops
@@ -273,9 +277,24 @@ void wg_sample_queue_flush(struct wg_sample_queue *queue, bool all)
         }
     }
 
+    /* Flushing all samples only happens along with a transform flush. */
+    if (all)
+        queue->accepts_input = true;
+
     LeaveCriticalSection(&queue->cs);
 }
 
+bool wg_sample_queue_accepts_input(struct wg_sample_queue *queue)
+{
+    bool accepts_input;
+
+    EnterCriticalSection(&queue->cs);
+    accepts_input = queue->accepts_input;
+    LeaveCriticalSection(&queue->cs);
+
+    return accepts_input;
+}
+
 HRESULT wg_sample_queue_create(struct wg_sample_queue **out)
 {
     struct wg_sample_queue *queue;
@@ -286,6 +305,7 @@ HRESULT wg_sample_queue_create(struct wg_sample_queue **out)
     InitializeCriticalSectionEx(&queue->cs, 0, RTL_CRITICAL_SECTION_FLAG_FORCE_DEBUG_INFO);
     queue->cs.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": cs");
     list_init(&queue->samples);
+    queue->accepts_input = true;
 
     TRACE("Created wg_sample_queue %p.\n", queue);
     *out = queue;
@@ -306,9 +326,70 @@ void wg_sample_queue_destroy(struct wg_sample_queue *queue)
 /* These unixlib entry points should not be used directly, they assume samples
  * to be queued and zero-copy support, use the helpers below instead.
  */
-HRESULT wg_transform_push_data(wg_transform_t transform, struct wg_sample *sample);
+HRESULT wg_transform_push_data(wg_transform_t transform, struct wg_sample *sample, bool *accepts_input);
 HRESULT wg_transform_read_data(wg_transform_t transform, struct wg_sample *sample,
-        struct wg_format *format);
+        struct wg_format *format, bool *accepts_input);
+HRESULT wg_transform_drain_data(wg_transform_t transform);
+HRESULT wg_transform_flush_data(wg_transform_t transform);
+
+static void wg_sample_queue_set_accepts_input(struct wg_sample_queue *queue, bool accepts_input)
+{
+    EnterCriticalSection(&queue->cs);
+    queue->accepts_input = accepts_input;
+    LeaveCriticalSection(&queue->cs);
+}
+
+static HRESULT wg_sample_queue_push(struct wg_sample_queue *queue, wg_transform_t transform,
+        struct wg_sample *wg_sample)
+{
+    bool accepts_input = true;
+    HRESULT hr;
+
+    wg_sample_queue_begin_append(queue, wg_sample);
+    hr = wg_transform_push_data(transform, wg_sample, &accepts_input);
+    wg_sample_queue_set_accepts_input(queue, accepts_input);
+    wg_sample_queue_end_append(queue, wg_sample);
+
+    return hr;
+}
+
+static HRESULT wg_sample_queue_read(struct wg_sample_queue *queue, wg_transform_t transform,
+        struct wg_sample *wg_sample, struct wg_format *format)
+{
+    bool accepts_input = true;
+    HRESULT hr;
+
+    hr = wg_transform_read_data(transform, wg_sample, format, &accepts_input);
+    wg_sample_queue_set_accepts_input(queue, accepts_input);
+
+    return hr;
+}
+
+HRESULT wg_transform_drain(wg_transform_t transform, struct wg_sample_queue *queue)
+{
+    HRESULT hr;
+
+    TRACE_(mfplat)("transform %#I64x, queue %p.\n", transform, queue);
+
+    /* Draining pushes all queued input, even if it fails. */
+    hr = wg_transform_drain_data(transform);
+    wg_sample_queue_set_accepts_input(queue, true);
+
+    return hr;
+}
+
+HRESULT wg_transform_flush(wg_transform_t transform, struct wg_sample_queue *queue)
+{
+    HRESULT hr;
+
+    TRACE_(mfplat)("transform %#I64x, queue %p.\n", transform, queue);
+
+    /* Flushing drops all queued input, even if it fails. */
+    hr = wg_transform_flush_data(transform);
+    wg_sample_queue_set_accepts_input(queue, true);
+
+    return hr;
+}
 
 HRESULT wg_transform_push_mf(wg_transform_t transform, IMFSample *sample,
         struct wg_sample_queue *queue)
@@ -338,28 +419,25 @@ HRESULT wg_transform_push_mf(wg_transform_t transform, IMFSample *sample,
     if (SUCCEEDED(IMFSample_GetUINT32(sample, &MFSampleExtension_Discontinuity, &value)) && value)
         wg_sample->flags |= WG_SAMPLE_FLAG_DISCONTINUITY;
 
-    wg_sample_queue_begin_append(queue, wg_sample);
-    hr = wg_transform_push_data(transform, wg_sample);
-    wg_sample_queue_end_append(queue, wg_sample);
-
-    return hr;
+    return wg_sample_queue_push(queue, transform, wg_sample);
 }
 
 HRESULT wg_transform_read_mf(wg_transform_t transform, IMFSample *sample,
-        DWORD sample_size, struct wg_format *format, DWORD *flags)
+        DWORD sample_size, struct wg_format *format, DWORD *flags, struct wg_sample_queue *queue)
 {
     struct wg_sample *wg_sample;
     IMFMediaBuffer *buffer;
     HRESULT hr;
 
-    TRACE_(mfplat)("transform %#I64x, sample %p, format %p, flags %p.\n", transform, sample, format, flags);
+    TRACE_(mfplat)("transform %#I64x, sample %p, format %p, flags %p, queue %p.\n",
+            transform, sample, format, flags, queue);
 
     if (FAILED(hr = wg_sample_create_mf(sample, &wg_sample)))
         return hr;
 
     wg_sample->size = 0;
 
-    if (FAILED(hr = wg_transform_read_data(transform, wg_sample, format)))
+    if (FAILED(hr = wg_sample_queue_read(queue, transform, wg_sample, format)))
     {
         if (hr == MF_E_TRANSFORM_STREAM_CHANGE && !format)
             FIXME("Unexpected stream format change!\n");
@@ -414,23 +492,20 @@ HRESULT wg_transform_push_quartz(wg_transform_t transform, struct wg_sample *wg_
     if (IMediaSample_IsDiscontinuity(sample->u.quartz.sample) == S_OK)
         wg_sample->flags |= WG_SAMPLE_FLAG_DISCONTINUITY;
 
-    wg_sample_queue_begin_append(queue, wg_sample);
-    hr = wg_transform_push_data(transform, wg_sample);
-    wg_sample_queue_end_append(queue, wg_sample);
-
-    return hr;
+    return wg_sample_queue_push(queue, transform, wg_sample);
 }
 
-HRESULT wg_transform_read_quartz(wg_transform_t transform, struct wg_sample *wg_sample)
+HRESULT wg_transform_read_quartz(wg_transform_t transform, struct wg_sample *wg_sample,
+        struct wg_sample_queue *queue)
 {
     struct sample *sample = unsafe_quartz_from_wg_sample(wg_sample);
     REFERENCE_TIME start_time, end_time;
     HRESULT hr;
     BOOL value;
 
-    TRACE_(mfplat)("transform %#I64x, wg_sample %p.\n", transform, wg_sample);
+    TRACE_(mfplat)("transform %#I64x, wg_sample %p, queue %p.\n", transform, wg_sample, queue);
 
-    if (FAILED(hr = wg_transform_read_data(transform, wg_sample, NULL)))
+    if (FAILED(hr = wg_sample_queue_read(queue, transform, wg_sample, NULL)))
     {
         if (hr == MF_E_TRANSFORM_STREAM_CHANGE)
             FIXME("Unexpected stream format change!\n");
@@ -487,25 +562,22 @@ HRESULT wg_transform_push_dmo(wg_transform_t transform, IMediaBuffer *media_buff
         wg_sample->duration = time_length;
     }
 
-    wg_sample_queue_begin_append(queue, wg_sample);
-    hr = wg_transform_push_data(transform, wg_sample);
-    wg_sample_queue_end_append(queue, wg_sample);
-
-    return hr;
+    return wg_sample_queue_push(queue, transform, wg_sample);
 }
 
-HRESULT wg_transform_read_dmo(wg_transform_t transform, DMO_OUTPUT_DATA_BUFFER *buffer)
+HRESULT wg_transform_read_dmo(wg_transform_t transform, DMO_OUTPUT_DATA_BUFFER *buffer,
+        struct wg_sample_queue *queue)
 {
     struct wg_sample *wg_sample;
     HRESULT hr;
 
-    TRACE_(mfplat)("transform %#I64x, buffer %p.\n", transform, buffer);
+    TRACE_(mfplat)("transform %#I64x, buffer %p, queue %p.\n", transform, buffer, queue);
 
     if (FAILED(hr = wg_sample_create_dmo(buffer->pBuffer, &wg_sample)))
         return hr;
     wg_sample->size = 0;
 
-    if (FAILED(hr = wg_transform_read_data(transform, wg_sample, NULL)))
+    if (FAILED(hr = wg_sample_queue_read(queue, transform, wg_sample, NULL)))
     {
         if (hr == MF_E_TRANSFORM_STREAM_CHANGE)
             TRACE_(mfplat)("Stream format changed.\n");
@@ -61,6 +61,8 @@ struct wg_transform
     GstSample *output_sample;
     bool output_caps_changed;
     GstCaps *output_caps;
+
+    struct wg_transform_stats stats;
 };
 
 static struct wg_transform *get_transform(wg_transform_t trans)
@@ -68,6 +70,11 @@ static struct wg_transform *get_transform(wg_transform_t trans)
     return (struct wg_transform *)(ULONG_PTR)trans;
 }
 
+static bool transform_accepts_input(struct wg_transform *transform)
+{
+    return gst_atomic_queue_length(transform->input_queue) < transform->attrs.input_queue_length + 1;
+}
+
 static void align_video_info_planes(gsize plane_align, GstVideoInfo *info, GstVideoAlignment *align)
 {
     gst_video_alignment_reset(align);
@@ -315,6 +322,9 @@ NTSTATUS wg_transform_destroy(void *args)
     while ((sample = gst_atomic_queue_pop(transform->output_queue)))
         gst_sample_unref(sample);
 
+    GST_INFO("transform %p, zero-copy %"G_GUINT64_FORMAT" bytes, copied %"G_GUINT64_FORMAT" bytes",
+            transform, (guint64)transform->stats.zero_copy_bytes, (guint64)transform->stats.copied_bytes);
+
     wg_allocator_destroy(transform->allocator);
     g_object_unref(transform->container);
     g_object_unref(transform->my_sink);
@@ -680,12 +690,11 @@ NTSTATUS wg_transform_push_data(void *args)
     struct wg_transform *transform = get_transform(params->transform);
     struct wg_sample *sample = params->sample;
     GstBuffer *buffer;
-    guint length;
 
-    length = gst_atomic_queue_length(transform->input_queue);
-    if (length >= transform->attrs.input_queue_length + 1)
+    if (!(params->accepts_input = transform_accepts_input(transform)))
     {
-        GST_INFO("Refusing %u bytes, %u buffers already queued", sample->size, length);
+        GST_INFO("Refusing %u bytes, %u buffers already queued", sample->size,
+                gst_atomic_queue_length(transform->input_queue));
         params->result = MF_E_NOTACCEPTING;
         return STATUS_SUCCESS;
     }
@@ -712,6 +721,7 @@ NTSTATUS wg_transform_push_data(void *args)
         GST_BUFFER_FLAG_SET(buffer, GST_BUFFER_FLAG_DISCONT);
     gst_atomic_queue_push(transform->input_queue, buffer);
 
+    params->accepts_input = transform_accepts_input(transform);
     params->result = S_OK;
     return STATUS_SUCCESS;
 }
@@ -761,26 +771,25 @@ static NTSTATUS copy_video_buffer(GstBuffer *buffer, const GstVideoInfo *src_vid
 
 static NTSTATUS copy_buffer(GstBuffer *buffer, struct wg_sample *sample, gsize *total_size)
 {
-    GstMapInfo info;
-
-    if (!gst_buffer_map(buffer, &info, GST_MAP_READ))
-        return STATUS_UNSUCCESSFUL;
+    gsize size = gst_buffer_get_size(buffer);
 
-    if (sample->max_size >= info.size)
-        sample->size = info.size;
+    if (sample->max_size >= size)
+        sample->size = size;
     else
     {
         sample->flags |= WG_SAMPLE_FLAG_INCOMPLETE;
         sample->size = sample->max_size;
     }
 
-    memcpy(wg_sample_data(sample), info.data, sample->size);
-    gst_buffer_unmap(buffer, &info);
+    /* Extract rather than map, mapping a buffer with several memories
+     * would merge them into a temporary copy first. */
+    if (gst_buffer_extract(buffer, 0, wg_sample_data(sample), sample->size) != sample->size)
+        return STATUS_UNSUCCESSFUL;
 
     if (sample->flags & WG_SAMPLE_FLAG_INCOMPLETE)
         gst_buffer_resize(buffer, sample->size, -1);
 
-    *total_size = info.size;
+    *total_size = size;
     return STATUS_SUCCESS;
 }
 
@@ -811,24 +820,31 @@ static void set_sample_flags_from_buffer(struct wg_sample *sample, GstBuffer *bu
 
 static bool sample_needs_buffer_copy(struct wg_sample *sample, GstBuffer *buffer, gsize *total_size)
 {
+    GstMemory *memory;
     GstMapInfo info;
     bool needs_copy;
 
-    if (!gst_buffer_map(buffer, &info, GST_MAP_READ))
+    *total_size = sample->size = gst_buffer_get_size(buffer);
+
+    /* Only a buffer with a single memory can have been written in place,
+     * don't map other buffers, as that would merge their memories. */
+    if (gst_buffer_n_memory(buffer) != 1)
+        return true;
+
+    memory = gst_buffer_peek_memory(buffer, 0);
+    if (!gst_memory_map(memory, &info, GST_MAP_READ))
     {
         GST_ERROR("Failed to map buffer %"GST_PTR_FORMAT, buffer);
-        sample->size = 0;
-        return STATUS_UNSUCCESSFUL;
+        return true;
     }
     needs_copy = info.data != wg_sample_data(sample);
-    *total_size = sample->size = info.size;
-    gst_buffer_unmap(buffer, &info);
+    gst_memory_unmap(memory, &info);
 
     return needs_copy;
 }
 
-static NTSTATUS read_transform_output_video(struct wg_sample *sample, GstBuffer *buffer,
-        const GstVideoInfo *src_video_info, const GstVideoInfo *dst_video_info)
+static NTSTATUS read_transform_output_video(struct wg_transform *transform, struct wg_sample *sample,
+        GstBuffer *buffer, const GstVideoInfo *src_video_info, const GstVideoInfo *dst_video_info)
 {
     gsize total_size;
     NTSTATUS status;
@@ -849,16 +865,23 @@ static NTSTATUS read_transform_output_video(struct wg_sample *sample, GstBuffer
     set_sample_flags_from_buffer(sample, buffer, total_size);
 
     if (needs_copy)
+    {
+        transform->stats.copied_bytes += sample->size;
         GST_WARNING("Copied %u bytes, sample %p, flags %#x", sample->size, sample, sample->flags);
-    else if (sample->flags & WG_SAMPLE_FLAG_INCOMPLETE)
-        GST_ERROR("Partial read %u bytes, sample %p, flags %#x", sample->size, sample, sample->flags);
+    }
     else
-        GST_INFO("Read %u bytes, sample %p, flags %#x", sample->size, sample, sample->flags);
+    {
+        transform->stats.zero_copy_bytes += sample->size;
+        if (sample->flags & WG_SAMPLE_FLAG_INCOMPLETE)
+            GST_ERROR("Partial read %u bytes, sample %p, flags %#x", sample->size, sample, sample->flags);
+        else
+            GST_INFO("Read %u bytes, sample %p, flags %#x", sample->size, sample, sample->flags);
+    }
 
     return STATUS_SUCCESS;
 }
 
-static NTSTATUS read_transform_output(struct wg_sample *sample, GstBuffer *buffer)
+static NTSTATUS read_transform_output(struct wg_transform *transform, struct wg_sample *sample, GstBuffer *buffer)
 {
     gsize total_size;
     NTSTATUS status;
@@ -879,11 +902,18 @@ static NTSTATUS read_transform_output(struct wg_sample *sample, GstBuffer *buffe
     set_sample_flags_from_buffer(sample, buffer, total_size);
 
     if (needs_copy)
+    {
+        transform->stats.copied_bytes += sample->size;
         GST_INFO("Copied %u bytes, sample %p, flags %#x", sample->size, sample, sample->flags);
-    else if (sample->flags & WG_SAMPLE_FLAG_INCOMPLETE)
-        GST_ERROR("Partial read %u bytes, sample %p, flags %#x", sample->size, sample, sample->flags);
+    }
     else
-        GST_INFO("Read %u bytes, sample %p, flags %#x", sample->size, sample, sample->flags);
+    {
+        transform->stats.zero_copy_bytes += sample->size;
+        if (sample->flags & WG_SAMPLE_FLAG_INCOMPLETE)
+            GST_ERROR("Partial read %u bytes, sample %p, flags %#x", sample->size, sample, sample->flags);
+        else
+            GST_INFO("Read %u bytes, sample %p, flags %#x", sample->size, sample, sample->flags);
+    }
 
     return STATUS_SUCCESS;
 }
@@ -908,10 +938,8 @@ static bool get_transform_output(struct wg_transform *transform, struct wg_sampl
     return !!transform->output_sample;
 }
 
-NTSTATUS wg_transform_read_data(void *args)
+static NTSTATUS transform_read_data(struct wg_transform *transform, struct wg_transform_read_data_params *params)
 {
-    struct wg_transform_read_data_params *params = args;
-    struct wg_transform *transform = get_transform(params->transform);
     GstVideoInfo src_video_info, dst_video_info;
     struct wg_sample *sample = params->sample;
     struct wg_format *format = params->format;
@@ -978,10 +1006,10 @@ NTSTATUS wg_transform_read_data(void *args)
     }
 
     if (stream_type_from_caps(output_caps) == GST_STREAM_TYPE_VIDEO)
-        status = read_transform_output_video(sample, output_buffer,
+        status = read_transform_output_video(transform, sample, output_buffer,
                 &src_video_info, &dst_video_info);
     else
-        status = read_transform_output(sample, output_buffer);
+        status = read_transform_output(transform, sample, output_buffer);
 
     if (status)
     {
@@ -1017,13 +1045,16 @@ NTSTATUS wg_transform_read_data(void *args)
     return STATUS_SUCCESS;
 }
 
-NTSTATUS wg_transform_get_status(void *args)
+NTSTATUS wg_transform_read_data(void *args)
 {
-    struct wg_transform_get_status_params *params = args;
+    struct wg_transform_read_data_params *params = args;
     struct wg_transform *transform = get_transform(params->transform);
+    NTSTATUS status;
 
-    params->accepts_input = gst_atomic_queue_length(transform->input_queue) < transform->attrs.input_queue_length + 1;
-    return STATUS_SUCCESS;
+    status = transform_read_data(transform, params);
+    /* Reading output consumes queued input, report the new input status. */
+    params->accepts_input = transform_accepts_input(transform);
+    return status;
 }
 
 NTSTATUS wg_transform_drain(void *args)
@@ -1085,6 +1116,15 @@ NTSTATUS wg_transform_flush(void *args)
     return STATUS_SUCCESS;
 }
 
+NTSTATUS wg_transform_get_stats(void *args)
+{
+    struct wg_transform_get_stats_params *params = args;
+    struct wg_transform *transform = get_transform(params->transform);
+
+    params->stats = transform->stats;
+    return STATUS_SUCCESS;
+}
+
 NTSTATUS wg_transform_notify_qos(void *args)
 {
     const struct wg_transform_notify_qos_params *params = args;
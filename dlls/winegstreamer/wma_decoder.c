@@ -552,7 +552,7 @@ static HRESULT WINAPI transform_ProcessOutput(IMFTransform *iface, DWORD flags,
         return hr;
 
     if (SUCCEEDED(hr = wg_transform_read_mf(decoder->wg_transform, samples->pSample,
-            info.cbSize, NULL, &samples->dwStatus)))
+            info.cbSize, NULL, &samples->dwStatus, decoder->wg_sample_queue)))
         wg_sample_queue_flush(decoder->wg_sample_queue, false);
 
     return hr;
@@ -872,7 +872,7 @@ static HRESULT WINAPI media_object_Flush(IMediaObject *iface)
 
     TRACE("iface %p.\n", iface);
 
-    if (FAILED(hr = wg_transform_flush(decoder->wg_transform)))
+    if (FAILED(hr = wg_transform_flush(decoder->wg_transform, decoder->wg_sample_queue)))
         return hr;
 
     wg_sample_queue_flush(decoder->wg_sample_queue, TRUE);
@@ -933,7 +933,7 @@ static HRESULT WINAPI media_object_ProcessOutput(IMediaObject *iface, DWORD flag
     if (!decoder->wg_transform)
         return DMO_E_TYPE_NOT_SET;
 
-    hr = wg_transform_read_dmo(decoder->wg_transform, buffers);
+    hr = wg_transform_read_dmo(decoder->wg_transform, buffers, decoder->wg_sample_queue);
 
     if (SUCCEEDED(hr))
     {
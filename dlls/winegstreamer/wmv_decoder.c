@@ -660,7 +660,7 @@ static HRESULT WINAPI media_object_Flush(IMediaObject *iface)
 
     TRACE("iface %p.\n", iface);
 
-    if (FAILED(hr = wg_transform_flush(decoder->wg_transform)))
+    if (FAILED(hr = wg_transform_flush(decoder->wg_transform, decoder->wg_sample_queue)))
         return hr;
 
     wg_sample_queue_flush(decoder->wg_sample_queue, TRUE);
@@ -729,8 +729,8 @@ static HRESULT WINAPI media_object_ProcessOutput(IMediaObject *iface, DWORD flag
     if (!decoder->wg_transform)
         return DMO_E_TYPE_NOT_SET;
 
-    if ((hr = wg_transform_read_dmo(decoder->wg_transform, buffers)) == MF_E_TRANSFORM_STREAM_CHANGE)
-        hr = wg_transform_read_dmo(decoder->wg_transform, buffers);
+    if ((hr = wg_transform_read_dmo(decoder->wg_transform, buffers, decoder->wg_sample_queue)) == MF_E_TRANSFORM_STREAM_CHANGE)
+        hr = wg_transform_read_dmo(decoder->wg_transform, buffers, decoder->wg_sample_queue);
 
     if (SUCCEEDED(hr))
         wg_sample_queue_flush(decoder->wg_sample_queue, false);
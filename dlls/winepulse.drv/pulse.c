@@ -82,6 +82,10 @@ struct pulse_stream
 
     INT64 clock_lastpos, clock_written;
 
+    /* Published under the lock, read without it by GetCurrentPadding. */
+    LONG ready;
+    LONG render_padding;
+
     struct list packet_free_head;
     struct list packet_filled_head;
 };
@@ -345,8 +349,10 @@ static void pulse_contextcallback(pa_context *c, void *userdata)
 
 static void pulse_stream_state(pa_stream *s, void *user)
 {
+    struct pulse_stream *stream = user;
     pa_stream_state_t state = pa_stream_get_state(s);
     TRACE("Stream state changed to %i\n", state);
+    if (stream) WriteRelease(&stream->ready, state == PA_STREAM_READY);
     pulse_broadcast();
 }
 
@@ -385,6 +391,17 @@ static BOOL pulse_stream_valid(struct pulse_stream *stream)
     return pa_stream_get_state(stream->stream) == PA_STREAM_READY;
 }
 
+static UINT32 pulse_render_padding(struct pulse_stream *stream)
+{
+    return stream->held_bytes / pa_frame_size(&stream->ss);
+}
+
+/* Must be called with the lock held whenever held_bytes of a render stream changes. */
+static void pulse_publish_render_padding(struct pulse_stream *stream)
+{
+    WriteRelease(&stream->render_padding, pulse_render_padding(stream));
+}
+
 static HRESULT pulse_connect(const char *name)
 {
     pa_context_state_t state;
@@ -1226,6 +1243,7 @@ exit:
         free(stream->local_buffer);
         if (stream->stream) {
             pa_stream_disconnect(stream->stream);
+            pa_stream_set_state_callback(stream->stream, NULL, NULL);
             pa_stream_unref(stream->stream);
         }
         free(stream);
@@ -1253,6 +1271,7 @@ static NTSTATUS pulse_release_stream(void *args)
         while (PA_STREAM_IS_GOOD(pa_stream_get_state(stream->stream)))
             pulse_cond_wait();
     }
+    pa_stream_set_state_callback(stream->stream, NULL, NULL);
     pa_stream_unref(stream->stream);
     pulse_unlock();
 
@@ -1637,6 +1656,7 @@ static NTSTATUS pulse_timer_loop(void *args)
                     stream->lcl_offs_bytes += adv_bytes;
                     stream->lcl_offs_bytes %= stream->real_bufsize_bytes;
                     stream->held_bytes -= adv_bytes;
+                    pulse_publish_render_padding(stream);
                 }
                 else if(stream->dataflow == eCapture)
                 {
@@ -1809,6 +1829,7 @@ static NTSTATUS pulse_reset(void *args)
             stream->clock_lastpos = stream->clock_written = 0;
             stream->pa_offs_bytes = stream->lcl_offs_bytes = 0;
             stream->held_bytes = stream->pa_held_bytes = 0;
+            pulse_publish_render_padding(stream);
         }
     }
     else
@@ -1852,11 +1873,6 @@ static BOOL alloc_tmp_buffer(struct pulse_stream *stream, SIZE_T bytes)
     return TRUE;
 }
 
-static UINT32 pulse_render_padding(struct pulse_stream *stream)
-{
-    return stream->held_bytes / pa_frame_size(&stream->ss);
-}
-
 static UINT32 pulse_capture_padding(struct pulse_stream *stream)
 {
     ACPacket *packet = stream->locked_ptr;
@@ -1994,6 +2010,7 @@ static NTSTATUS pulse_release_render_buffer(void *args)
     }
     stream->clock_written += written_bytes;
     stream->locked = 0;
+    pulse_publish_render_padding(stream);
 
     /* push as much data as we can to pulseaudio too */
     pulse_write(stream);
@@ -2309,6 +2326,21 @@ static NTSTATUS pulse_get_current_padding(void *args)
     struct get_current_padding_params *params = args;
     struct pulse_stream *stream = handle_get_stream(params->stream);
 
+    /* Render padding is polled often by clients, avoid taking the lock for it. */
+    if (stream->dataflow == eRender)
+    {
+        if (!ReadAcquire(&stream->ready))
+        {
+            params->result = AUDCLNT_E_DEVICE_INVALIDATED;
+            return STATUS_SUCCESS;
+        }
+        *params->padding = ReadAcquire(&stream->render_padding);
+        TRACE("%p Pad: %u ms (%u)\n", stream, muldiv(*params->padding, 1000, stream->ss.rate),
+              *params->padding);
+        params->result = S_OK;
+        return STATUS_SUCCESS;
+    }
+
     pulse_lock();
     if (!pulse_stream_valid(stream))
     {
@@ -2317,10 +2349,7 @@ static NTSTATUS pulse_get_current_padding(void *args)
         return STATUS_SUCCESS;
     }
 
-    if (stream->dataflow == eRender)
-        *params->padding = pulse_render_padding(stream);
-    else
-        *params->padding = pulse_capture_padding(stream);
+    *params->padding = pulse_capture_padding(stream);
     pulse_unlock();
 
     TRACE("%p Pad: %u ms (%u)\n", stream, muldiv(*params->padding, 1000, stream->ss.rate),
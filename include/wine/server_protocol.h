@@ -859,6 +859,26 @@ typedef struct
 } cursor_pos_t;
 
 
+typedef volatile struct
+{
+    unsigned int         seq;
+    int                  cursor_x;
+    int                  cursor_y;
+    unsigned int         cursor_last_change;
+    unsigned int         hooks_serial;
+    unsigned char        keystate[256];
+} desktop_shm_t;
+
+typedef volatile struct
+{
+    unsigned int         seq;
+    unsigned int         wake_bits;
+    unsigned int         wake_mask;
+    unsigned int         changed_bits;
+    unsigned int         changed_mask;
+} queue_shm_t;
+
+
 
 
 
@@ -1996,6 +2016,8 @@ struct get_image_map_address_reply
 {
     struct reply_header __header;
     client_ptr_t addr;
+    obj_handle_t reloc_file;
+    char __pad_20[4];
 };
 
 
@@ -5757,6 +5779,22 @@ struct get_fast_alert_event_reply
 };
 
 
+
+struct get_user_shared_memory_request
+{
+    struct request_header __header;
+    char __pad_12[4];
+};
+struct get_user_shared_memory_reply
+{
+    struct reply_header __header;
+    obj_handle_t desktop;
+    obj_handle_t queue;
+    unsigned int queue_block;
+    unsigned int queue_offset;
+};
+
+
 enum request
 {
     REQ_new_process,
@@ -6051,6 +6089,7 @@ enum request
     REQ_fast_select_queue,
     REQ_fast_unselect_queue,
     REQ_get_fast_alert_event,
+    REQ_get_user_shared_memory,
     REQ_NB_REQUESTS
 };
 
@@ -6350,6 +6389,7 @@ union generic_request
     struct fast_select_queue_request fast_select_queue_request;
     struct fast_unselect_queue_request fast_unselect_queue_request;
     struct get_fast_alert_event_request get_fast_alert_event_request;
+    struct get_user_shared_memory_request get_user_shared_memory_request;
 };
 union generic_reply
 {
@@ -6647,11 +6687,12 @@ union generic_reply
     struct fast_select_queue_reply fast_select_queue_reply;
     struct fast_unselect_queue_reply fast_unselect_queue_reply;
     struct get_fast_alert_event_reply get_fast_alert_event_reply;
+    struct get_user_shared_memory_reply get_user_shared_memory_reply;
 };
 
 /* ### protocol_version begin ### */
 
-#define SERVER_PROTOCOL_VERSION 800
+#define SERVER_PROTOCOL_VERSION 804
 
 /* ### protocol_version end ### */
 
@@ -90,6 +90,8 @@ struct dir
     int            want_data; /* return change data */
     int            subtree;  /* do we want to watch subdirectories? */
     struct list    change_records;   /* data for the change */
+    data_size_t    records_size;     /* total size of the queued change records */
+    int            overflow;         /* too many changes were queued, the client has to rescan */
     struct list    in_entry; /* entry in the inode dirs list */
     struct inode  *inode;    /* inode of the associated directory */
     struct process *client_process;  /* client process that has a cache for this directory */
@@ -260,6 +262,25 @@ static void dnotify_adjust_changes( struct dir *dir )
 #endif
 }
 
+static struct change_record *get_first_change_record( struct dir *dir )
+{
+    struct list *ptr = list_head( &dir->change_records );
+    if (!ptr) return NULL;
+    list_remove( ptr );
+    return LIST_ENTRY( ptr, struct change_record, entry );
+}
+
+/* maximum amount of change data queued for a directory before reporting an overflow */
+#define MAX_CHANGE_RECORDS_SIZE 0x100000
+
+static void free_change_records( struct dir *dir )
+{
+    struct change_record *record;
+
+    while ((record = get_first_change_record( dir ))) free( record );
+    dir->records_size = 0;
+}
+
 /* insert change in the global list */
 static inline void insert_change( struct dir *dir )
 {
@@ -354,14 +375,6 @@ static int dir_set_sd( struct object *obj, const struct security_descriptor *sd,
     return ret;
 }
 
-static struct change_record *get_first_change_record( struct dir *dir )
-{
-    struct list *ptr = list_head( &dir->change_records );
-    if (!ptr) return NULL;
-    list_remove( ptr );
-    return LIST_ENTRY( ptr, struct change_record, entry );
-}
-
 static int dir_close_handle( struct object *obj, struct process *process, obj_handle_t handle )
 {
     struct dir *dir = (struct dir *)obj;
@@ -372,7 +385,6 @@ static int dir_close_handle( struct object *obj, struct process *process, obj_ha
 
 static void dir_destroy( struct object *obj )
 {
-    struct change_record *record;
     struct dir *dir = (struct dir *)obj;
     assert (obj->ops == &dir_ops);
 
@@ -385,7 +397,7 @@ static void dir_destroy( struct object *obj )
         free_inode( dir->inode );
     }
 
-    while ((record = get_first_change_record( dir ))) free( record );
+    free_change_records( dir );
 
     release_dir_cache_entry( dir );
     release_object( dir->fd );
@@ -606,12 +618,32 @@ static void inotify_do_change_notify( struct dir *dir, unsigned int action,
                                       unsigned int cookie, const char *relpath )
 {
     struct change_record *record;
+    struct list *ptr;
 
     assert( dir->obj.ops == &dir_ops );
 
-    if (dir->want_data)
+    if (dir->want_data && !dir->overflow)
     {
         size_t len = strlen(relpath);
+        data_size_t size = offsetof(struct filesystem_event, name[len]);
+
+        /* a file being written usually generates a burst of identical modifications */
+        if (action == FILE_ACTION_MODIFIED && (ptr = list_tail( &dir->change_records )))
+        {
+            record = LIST_ENTRY( ptr, struct change_record, entry );
+            if (record->event.action == action && record->event.len == len &&
+                !memcmp( record->event.name, relpath, len ))
+                goto done;
+        }
+
+        if (dir->records_size + size > MAX_CHANGE_RECORDS_SIZE)
+        {
+            /* the client can't keep up, let it rescan the directory instead */
+            free_change_records( dir );
+            dir->overflow = 1;
+            goto done;
+        }
+
         record = malloc( offsetof(struct change_record, event.name[len]) );
         if (!record)
             return;
@@ -622,8 +654,11 @@ static void inotify_do_change_notify( struct dir *dir, unsigned int action,
         record->event.len = len;
 
         list_add_tail( &dir->change_records, &record->entry );
+        dir->records_size += size;
     }
 
+done:
+
     fd_async_wake_up( dir->fd, ASYNC_TYPE_WAIT, STATUS_ALERTED );
 }
 
@@ -843,7 +878,7 @@ static void inotify_notify_all( struct inotify_event *ie )
 static void inotify_poll_event( struct fd *fd, int event )
 {
     int r, ofs, unix_fd;
-    char buffer[0x1000];
+    char buffer[0x10000];
     struct inotify_event *ie;
 
     unix_fd = get_unix_fd( fd );
@@ -1089,6 +1124,8 @@ struct object *create_dir_obj( struct fd *fd, unsigned int access, mode_t mode,
         return NULL;
 
     list_init( &dir->change_records );
+    dir->records_size = 0;
+    dir->overflow = 0;
     dir->filter = 0;
     dir->notified = 0;
     dir->want_data = 0;
@@ -1166,8 +1203,8 @@ DECL_HANDLER(read_directory_changes)
         dir->want_data = req->want_data;
     }
 
-    /* if there's already a change in the queue, send it */
-    if (!list_empty( &dir->change_records ))
+    /* if there's already a change or an overflow in the queue, send it */
+    if (dir->overflow || !list_empty( &dir->change_records ))
         fd_async_wake_up( dir->fd, ASYNC_TYPE_WAIT, STATUS_ALERTED );
 
     /* setup the real notification */
@@ -1193,8 +1230,17 @@ DECL_HANDLER(read_change)
     if (!dir)
         return;
 
+    if (dir->overflow)
+    {
+        dir->overflow = 0;
+        release_object( dir );
+        set_error( STATUS_NOTIFY_ENUM_DIR );
+        return;
+    }
+
     list_init( &events );
     list_move_tail( &events, &dir->change_records );
+    dir->records_size = 0;
     release_object( dir );
 
     if (list_empty( &events ))
@@ -295,6 +295,7 @@ static void hook_table_destroy( struct object *obj )
 /* remove a hook, freeing it if the chain is not in use */
 static void remove_hook( struct hook *hook )
 {
+    invalidate_active_hooks();
     if (hook->table->counts[hook->index])
         hook->proc = 0; /* chain is in use, just mark it and return */
     else
@@ -463,6 +464,7 @@ DECL_HANDLER(set_hook)
         hook->unicode     = req->unicode;
         hook->module      = module;
         hook->module_size = module_size;
+        invalidate_active_hooks();
         reply->handle = hook->handle;
         reply->active_hooks = get_active_hooks();
     }
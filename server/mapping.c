@@ -89,7 +89,8 @@ struct shared_map
 {
     struct object   obj;             /* object header */
     struct fd      *fd;              /* file descriptor of the mapped PE file */
-    struct file    *file;            /* temp file holding the shared data */
+    struct file    *file;            /* temp file holding the shared data, NULL if it couldn't be built */
+    client_ptr_t    base;            /* base address for a relocated image, 0 for shared sections */
     struct list     entry;           /* entry in global shared maps list */
 };
 
@@ -163,6 +164,7 @@ struct mapping
     pe_image_info_t image;           /* image info (for PE image mapping) */
     struct ranges  *committed;       /* list of committed ranges in this mapping */
     struct shared_map *shared;       /* temp file for shared PE mapping */
+    struct shared_map *relocated;    /* temp file for read-only sections relocated to map_addr */
 };
 
 static void mapping_dump( struct object *obj, int verbose );
@@ -260,7 +262,7 @@ static void shared_map_destroy( struct object *obj )
     struct shared_map *shared = (struct shared_map *)obj;
 
     release_object( shared->fd );
-    release_object( shared->file );
+    if (shared->file) release_object( shared->file );
     list_remove( &shared->entry );
 }
 
@@ -467,7 +469,18 @@ static struct shared_map *get_shared_file( struct fd *fd )
     struct shared_map *ptr;
 
     LIST_FOR_EACH_ENTRY( ptr, &shared_map_list, struct shared_map, entry )
-        if (is_same_file_fd( ptr->fd, fd ))
+        if (!ptr->base && is_same_file_fd( ptr->fd, fd ))
+            return (struct shared_map *)grab_object( ptr );
+    return NULL;
+}
+
+/* find the relocated PE mapping for a given mapping and base address */
+static struct shared_map *get_relocated_file( struct fd *fd, client_ptr_t base )
+{
+    struct shared_map *ptr;
+
+    LIST_FOR_EACH_ENTRY( ptr, &shared_map_list, struct shared_map, entry )
+        if (ptr->base == base && is_same_file_fd( ptr->fd, fd ))
             return (struct shared_map *)grab_object( ptr );
     return NULL;
 }
@@ -646,6 +659,7 @@ static int build_shared_mapping( struct mapping *mapping, int fd,
     if (!(shared = alloc_object( &shared_map_ops ))) goto error;
     shared->fd = (struct fd *)grab_object( mapping->fd );
     shared->file = file;
+    shared->base = 0;
     list_add_head( &shared_map_list, &shared->entry );
     mapping->shared = shared;
     free( buffer );
@@ -709,6 +723,166 @@ static int load_cfg_header( IMAGE_LOAD_CONFIG_DIRECTORY64 *cfg, size_t va, size_
     return 1;
 }
 
+/* apply the relocation blocks that fall inside a section buffer */
+static int relocate_section( char *buffer, size_t va, size_t size, const char *relocs, size_t relocs_size,
+                             INT64 delta )
+{
+    const IMAGE_BASE_RELOCATION *rel;
+    const USHORT *reloc;
+    size_t pos, offset;
+    unsigned int count;
+
+    for (pos = 0; pos + sizeof(*rel) <= relocs_size; pos += rel->SizeOfBlock)
+    {
+        rel = (const IMAGE_BASE_RELOCATION *)(relocs + pos);
+        if (rel->SizeOfBlock < sizeof(*rel) || rel->SizeOfBlock > relocs_size - pos) break;
+        if (rel->VirtualAddress < va || rel->VirtualAddress >= va + size) continue;
+
+        reloc = (const USHORT *)(rel + 1);
+        for (count = (rel->SizeOfBlock - sizeof(*rel)) / sizeof(USHORT); count; count--, reloc++)
+        {
+            offset = rel->VirtualAddress - va + (*reloc & 0xfff);
+            switch (*reloc >> 12)
+            {
+            case IMAGE_REL_BASED_ABSOLUTE:
+                break;
+            case IMAGE_REL_BASED_HIGH:
+                if (offset + sizeof(short) > size) return 0;
+                *(short *)(buffer + offset) += (short)(delta >> 16);
+                break;
+            case IMAGE_REL_BASED_LOW:
+                if (offset + sizeof(short) > size) return 0;
+                *(short *)(buffer + offset) += (short)delta;
+                break;
+            case IMAGE_REL_BASED_HIGHLOW:
+                if (offset + sizeof(int) > size) return 0;
+                *(int *)(buffer + offset) += (int)delta;
+                break;
+            case IMAGE_REL_BASED_DIR64:
+                if (offset + sizeof(INT64) > size) return 0;
+                *(INT64 *)(buffer + offset) += delta;
+                break;
+            default:
+                return 0;  /* let the client handle it */
+            }
+        }
+    }
+    return 1;
+}
+
+/* maximum size of the read-only sections relocated by the server, larger images are relocated by the client */
+#define MAX_RELOCATED_SECTIONS_SIZE (16 * 1024 * 1024)
+
+/* allocate and fill the temp file holding the read-only sections of a PE image relocated to base */
+static struct file *build_relocated_file( struct mapping *mapping, client_ptr_t base )
+{
+    struct file *file = NULL;
+    IMAGE_DOS_HEADER dos;
+    IMAGE_SECTION_HEADER sec[96];
+    struct
+    {
+        DWORD Signature;
+        IMAGE_FILE_HEADER FileHeader;
+        union
+        {
+            IMAGE_OPTIONAL_HEADER32 hdr32;
+            IMAGE_OPTIONAL_HEADER64 hdr64;
+        } opt;
+    } nt;
+    IMAGE_DATA_DIRECTORY *dir;
+    char *buffer = NULL, *relocs = NULL;
+    size_t map_size, file_size;
+    off_t file_start, pos;
+    unsigned int i, count;
+    int unix_fd, shared_fd;
+    size_t total_size = 0;
+    INT64 delta;
+    long res;
+
+    if (mapping->image.is_hybrid || mapping->image.machine == IMAGE_FILE_MACHINE_ARM64) return NULL;
+    if ((unix_fd = get_unix_fd( mapping->fd )) == -1) return NULL;
+
+    /* load the headers, they have been validated already by get_image_params */
+
+    if (pread( unix_fd, &dos, sizeof(dos), 0 ) != sizeof(dos)) return NULL;
+    pos = dos.e_lfanew;
+    memset( &nt, 0, sizeof(nt) );
+    if (pread( unix_fd, &nt, sizeof(nt), pos ) < sizeof(nt.Signature) + sizeof(nt.FileHeader)) return NULL;
+    if (nt.opt.hdr32.Magic == IMAGE_NT_OPTIONAL_HDR64_MAGIC)
+    {
+        delta = base - nt.opt.hdr64.ImageBase;
+        dir = &nt.opt.hdr64.DataDirectory[IMAGE_DIRECTORY_ENTRY_BASERELOC];
+    }
+    else
+    {
+        delta = base - nt.opt.hdr32.ImageBase;
+        dir = &nt.opt.hdr32.DataDirectory[IMAGE_DIRECTORY_ENTRY_BASERELOC];
+    }
+    if (!delta || !dir->VirtualAddress || !dir->Size) return NULL;
+
+    pos += sizeof(nt.Signature) + sizeof(nt.FileHeader) + nt.FileHeader.SizeOfOptionalHeader;
+    if ((count = nt.FileHeader.NumberOfSections) > ARRAY_SIZE( sec )) return NULL;
+    if (pread( unix_fd, sec, count * sizeof(*sec), pos ) != count * sizeof(*sec)) return NULL;
+
+    /* this is done synchronously in the request, don't block the server for too long */
+    for (i = 0; i < count; i++)
+    {
+        if (sec[i].Characteristics & IMAGE_SCN_MEM_WRITE) continue;
+        get_section_sizes( &sec[i], &map_size, &file_start, &file_size );
+        if ((total_size += file_size) > MAX_RELOCATED_SECTIONS_SIZE) return NULL;
+    }
+
+    if (!(relocs = malloc( dir->Size ))) return NULL;
+    if (load_data_dir( relocs, dir->Size, dir->VirtualAddress, dir->Size, unix_fd, sec, count ) != dir->Size)
+        goto error;
+
+    /* copy the read-only sections at their virtual address and relocate them */
+
+    if ((shared_fd = create_temp_file( mapping->image.map_size )) == -1) goto error;
+    if (!(file = create_file_for_fd( shared_fd, FILE_GENERIC_READ|FILE_GENERIC_WRITE, 0 ))) goto error;
+
+    for (i = 0; i < count; i++)
+    {
+        if (sec[i].Characteristics & IMAGE_SCN_MEM_WRITE) continue;
+        get_section_sizes( &sec[i], &map_size, &file_start, &file_size );
+        if (!sec[i].PointerToRawData || !file_size) continue;
+        if (sec[i].VirtualAddress + file_size > mapping->image.map_size) goto error;
+
+        if (!(buffer = realloc( buffer, file_size ))) goto error;
+        if ((res = pread( unix_fd, buffer, file_size, file_start )) < 0) goto error;
+        memset( buffer + res, 0, file_size - res );
+
+        if (!relocate_section( buffer, sec[i].VirtualAddress, file_size, relocs, dir->Size, delta ))
+            goto error;
+        if (pwrite( shared_fd, buffer, file_size, sec[i].VirtualAddress ) != file_size) goto error;
+    }
+
+    free( buffer );
+    free( relocs );
+    return file;
+
+ error:
+    if (file) release_object( file );
+    free( buffer );
+    free( relocs );
+    return NULL;
+}
+
+/* get the relocated read-only sections for a PE image, building them on first use;
+ * failures are cached too so that the image isn't read again on every map */
+static struct shared_map *build_relocated_mapping( struct mapping *mapping, client_ptr_t base )
+{
+    struct shared_map *shared;
+
+    if ((shared = get_relocated_file( mapping->fd, base ))) return shared;
+    if (!(shared = alloc_object( &shared_map_ops ))) return NULL;
+    shared->fd = (struct fd *)grab_object( mapping->fd );
+    shared->file = build_relocated_file( mapping, base );
+    shared->base = base;
+    list_add_head( &shared_map_list, &shared->entry );
+    return shared;
+}
+
 /* retrieve the mapping parameters for an executable (PE) image */
 static unsigned int get_image_params( struct mapping *mapping, file_pos_t file_size, int unix_fd )
 {
@@ -982,6 +1156,7 @@ static struct mapping *create_mapping( struct object *root, const struct unicode
     mapping->size        = size;
     mapping->fd          = NULL;
     mapping->shared      = NULL;
+    mapping->relocated   = NULL;
     mapping->committed   = NULL;
 
     if (!(mapping->flags = get_mapping_flags( handle, flags ))) goto error;
@@ -1071,6 +1246,7 @@ struct mapping *create_fd_mapping( struct object *root, const struct unicode_str
     if (get_error() == STATUS_OBJECT_NAME_EXISTS) return mapping;  /* Nothing else to do */
 
     mapping->shared    = NULL;
+    mapping->relocated = NULL;
     mapping->committed = NULL;
     mapping->flags     = SEC_FILE;
     mapping->fd        = (struct fd *)grab_object( fd );
@@ -1183,6 +1359,7 @@ static void mapping_destroy( struct object *obj )
     if (mapping->fd) release_object( mapping->fd );
     if (mapping->committed) release_object( mapping->committed );
     if (mapping->shared) release_object( mapping->shared );
+    if (mapping->relocated) release_object( mapping->relocated );
 }
 
 static enum server_fd_type mapping_get_fd_type( struct fd *fd )
@@ -1276,6 +1453,34 @@ struct object *create_user_data_mapping( struct object *root, const struct unico
     return &mapping->obj;
 }
 
+/* create an anonymous mapping holding data that the server shares with its clients */
+struct object *create_shared_mapping( mem_size_t size, void **ptr )
+{
+    static const struct unicode_str empty_str;
+    struct mapping *mapping;
+
+    if (!(mapping = create_mapping( NULL, &empty_str, 0, size, SEC_COMMIT, 0,
+                                    FILE_READ_DATA | FILE_WRITE_DATA, NULL ))) return NULL;
+    *ptr = mmap( NULL, mapping->size, PROT_READ | PROT_WRITE, MAP_SHARED, get_unix_fd( mapping->fd ), 0 );
+    if (*ptr == MAP_FAILED)
+    {
+        file_set_error();
+        release_object( mapping );
+        *ptr = NULL;
+        return NULL;
+    }
+    return &mapping->obj;
+}
+
+/* free a mapping created with create_shared_mapping */
+void free_shared_mapping( struct object *obj, void *ptr )
+{
+    struct mapping *mapping = (struct mapping *)obj;
+
+    munmap( ptr, mapping->size );
+    release_object( mapping );
+}
+
 /* create a file mapping */
 DECL_HANDLER(create_mapping)
 {
@@ -1361,6 +1566,15 @@ DECL_HANDLER(get_image_map_address)
     {
         if (!mapping->image.map_addr) mapping->image.map_addr = assign_map_address( mapping );
         reply->addr = mapping->image.map_addr;
+
+        /* share the relocated read-only pages between all processes mapping the image at that address */
+        if (reply->addr && reply->addr != mapping->image.base && !mapping->relocated)
+        {
+            mapping->relocated = build_relocated_mapping( mapping, reply->addr );
+            clear_error();  /* the client falls back to relocating on its own */
+        }
+        if (mapping->relocated && mapping->relocated->file && mapping->relocated->base == reply->addr)
+            reply->reloc_file = alloc_handle( current->process, mapping->relocated->file, GENERIC_READ, 0 );
     }
     else set_error( STATUS_INVALID_PARAMETER );
 
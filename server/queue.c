@@ -148,6 +148,8 @@ struct msg_queue
     unsigned int           ignore_post_msg; /* ignore post messages newer than this unique id */
     struct fast_sync      *fast_sync;       /* fast synchronization object */
     int                    in_fast_wait;    /* are we in a client-side wait? */
+    unsigned int           shared_slot;     /* index of the queue shared memory slot */
+    queue_shm_t           *shared;          /* queue shared memory */
 };
 
 struct hotkey
@@ -244,6 +246,57 @@ static unsigned int cursor_history_latest;
 static void queue_hardware_message( struct desktop *desktop, struct message *msg, int always_queue );
 static void free_message( struct message *msg );
 
+/* the queue shared memory slots are allocated from blocks shared by all the clients */
+#define QUEUE_SHM_BLOCK_SIZE  0x10000
+#define QUEUE_SHM_BLOCK_SLOTS (QUEUE_SHM_BLOCK_SIZE / sizeof(queue_shm_t))
+
+struct queue_shm_block
+{
+    struct object         *mapping;         /* shared memory mapping of the block */
+    queue_shm_t           *slots;           /* slots of the block */
+};
+
+static struct queue_shm_block *queue_shm_blocks;
+static unsigned int queue_shm_block_count;
+static unsigned int *queue_shm_free_slots;  /* stack of the free slot indices */
+static unsigned int queue_shm_free_count;
+
+/* allocate a queue shared memory slot, adding a new block if needed */
+static queue_shm_t *alloc_queue_shm( unsigned int *slot )
+{
+    if (!queue_shm_free_count)
+    {
+        unsigned int i, count = queue_shm_block_count + 1;
+        struct queue_shm_block *blocks;
+        unsigned int *free_slots;
+        struct object *mapping;
+        void *ptr;
+
+        if (!(blocks = realloc( queue_shm_blocks, count * sizeof(*blocks) ))) return NULL;
+        queue_shm_blocks = blocks;
+        if (!(free_slots = realloc( queue_shm_free_slots, count * QUEUE_SHM_BLOCK_SLOTS * sizeof(*free_slots) )))
+            return NULL;
+        queue_shm_free_slots = free_slots;
+        if (!(mapping = create_shared_mapping( QUEUE_SHM_BLOCK_SIZE, &ptr ))) return NULL;
+
+        blocks[queue_shm_block_count].mapping = mapping;
+        blocks[queue_shm_block_count].slots = ptr;
+        for (i = QUEUE_SHM_BLOCK_SLOTS; i > 0; i--)
+            free_slots[queue_shm_free_count++] = queue_shm_block_count * QUEUE_SHM_BLOCK_SLOTS + i - 1;
+        queue_shm_block_count = count;
+    }
+
+    *slot = queue_shm_free_slots[--queue_shm_free_count];
+    return &queue_shm_blocks[*slot / QUEUE_SHM_BLOCK_SLOTS].slots[*slot % QUEUE_SHM_BLOCK_SLOTS];
+}
+
+/* return a slot to the free list, the blocks themselves are never freed */
+static void free_queue_shm( unsigned int slot, queue_shm_t *shared )
+{
+    memset( (void *)shared, 0, sizeof(*shared) );
+    queue_shm_free_slots[queue_shm_free_count++] = slot;
+}
+
 /* set the caret window in a given thread input */
 static void set_caret_window( struct thread_input *input, user_handle_t win )
 {
@@ -322,6 +375,7 @@ static struct msg_queue *create_msg_queue( struct thread *thread, struct thread_
         queue->ignore_post_msg = 0;
         queue->fast_sync       = NULL;
         queue->in_fast_wait    = 0;
+        if (!(queue->shared = alloc_queue_shm( &queue->shared_slot ))) clear_error();
         list_init( &queue->send_result );
         list_init( &queue->callback_result );
         list_init( &queue->pending_timers );
@@ -472,6 +526,21 @@ static int update_desktop_cursor_window( struct desktop *desktop, user_handle_t
     return updated;
 }
 
+/* publish the desktop cursor position and async key state in the shared memory */
+void update_desktop_shm( struct desktop *desktop )
+{
+    desktop_shm_t *shared = desktop->shared;
+
+    if (!shared) return;
+    shared_write_begin( &shared->seq );
+    shared->cursor_x = desktop->cursor.x;
+    shared->cursor_y = desktop->cursor.y;
+    shared->cursor_last_change = desktop->cursor.last_change;
+    shared->hooks_serial = desktop->hooks_serial;
+    memcpy( (void *)shared->keystate, desktop->keystate, sizeof(desktop->keystate) );
+    shared_write_end( &shared->seq );
+}
+
 static int update_desktop_cursor_pos( struct desktop *desktop, user_handle_t win, int x, int y )
 {
     int updated;
@@ -482,6 +551,7 @@ static int update_desktop_cursor_pos( struct desktop *desktop, user_handle_t win
     desktop->cursor.x = x;
     desktop->cursor.y = y;
     desktop->cursor.last_change = get_tick_count();
+    update_desktop_shm( desktop );
 
     if (!win || !is_window_visible( win ) || is_window_transparent( win ))
         win = shallow_window_from_point( desktop, x, y );
@@ -592,6 +662,20 @@ void set_queue_hooks( struct thread *thread, struct hook_table *hooks )
     queue->hooks = hooks;
 }
 
+/* publish the queue wake bits and masks in the shared memory */
+static void update_queue_shm( struct msg_queue *queue )
+{
+    queue_shm_t *shared = queue->shared;
+
+    if (!shared) return;
+    shared_write_begin( &shared->seq );
+    shared->wake_bits    = queue->wake_bits;
+    shared->wake_mask    = queue->wake_mask;
+    shared->changed_bits = queue->changed_bits;
+    shared->changed_mask = queue->changed_mask;
+    shared_write_end( &shared->seq );
+}
+
 /* check the queue status */
 static inline int is_signaled( struct msg_queue *queue )
 {
@@ -608,6 +692,7 @@ static inline void set_queue_bits( struct msg_queue *queue, unsigned int bits )
     }
     queue->wake_bits |= bits;
     queue->changed_bits |= bits;
+    update_queue_shm( queue );
     if (is_signaled( queue ))
     {
         wake_up( &queue->obj, 0 );
@@ -620,6 +705,7 @@ static inline void clear_queue_bits( struct msg_queue *queue, unsigned int bits
 {
     queue->wake_bits &= ~bits;
     queue->changed_bits &= ~bits;
+    update_queue_shm( queue );
     if (!(queue->wake_bits & (QS_KEY | QS_MOUSEBUTTON)))
     {
         if (queue->keystate_lock) unlock_input_keystate( queue->input );
@@ -1179,6 +1265,7 @@ static void msg_queue_satisfied( struct object *obj, struct wait_queue_entry *en
     struct msg_queue *queue = (struct msg_queue *)obj;
     queue->wake_mask = 0;
     queue->changed_mask = 0;
+    update_queue_shm( queue );
     fast_reset_event( queue->fast_sync );
 }
 
@@ -1230,6 +1317,7 @@ static void msg_queue_destroy( struct object *obj )
     if (queue->hooks) release_object( queue->hooks );
     if (queue->fd) release_object( queue->fd );
     if (queue->fast_sync) release_object( queue->fast_sync );
+    if (queue->shared) free_queue_shm( queue->shared_slot, queue->shared );
 }
 
 static void msg_queue_poll_event( struct fd *fd, int event )
@@ -1560,6 +1648,8 @@ static void update_input_key_state( struct desktop *desktop, unsigned char *keys
         }
         break;
     }
+
+    if (keystate == desktop->keystate) update_desktop_shm( desktop );
 }
 
 /* update the desktop key state according to a mouse message flags */
@@ -2059,6 +2149,7 @@ static int queue_mouse_message( struct desktop *desktop, user_handle_t win, cons
     };
 
     desktop->cursor.last_change = get_tick_count();
+    update_desktop_shm( desktop );
     flags = input->mouse.flags;
     time  = input->mouse.time;
     if (!time) time = desktop->cursor.last_change;
@@ -2216,6 +2307,7 @@ static int queue_keyboard_message( struct desktop *desktop, user_handle_t win, c
         desktop->keystate[VK_MENU] &= ~0x02;
         break;
     }
+    update_desktop_shm( desktop );
 
     if (!(send_flags & SEND_HWMSG_NO_RAW) && (foreground = get_foreground_thread( desktop, win )))
     {
@@ -2861,12 +2953,14 @@ DECL_HANDLER(set_queue_mask)
         queue->changed_mask = req->changed_mask;
         reply->wake_bits    = queue->wake_bits;
         reply->changed_bits = queue->changed_bits;
+        update_queue_shm( queue );
         if (is_signaled( queue ))
         {
             /* if skip wait is set, do what would have been done in the subsequent wait */
             if (req->skip_wait)
             {
                 queue->wake_mask = queue->changed_mask = 0;
+                update_queue_shm( queue );
                 fast_reset_event( queue->fast_sync );
             }
             else
@@ -2892,6 +2986,7 @@ DECL_HANDLER(get_queue_status)
         reply->wake_bits    = queue->wake_bits;
         reply->changed_bits = queue->changed_bits;
         queue->changed_bits &= ~req->clear_bits;
+        update_queue_shm( queue );
         if (!is_signaled( queue ))
             fast_reset_event( queue->fast_sync );
     }
@@ -3083,6 +3178,7 @@ DECL_HANDLER(get_message)
     }
     if (filter & QS_INPUT) queue->changed_bits &= ~QS_INPUT;
     if (filter & QS_PAINT) queue->changed_bits &= ~QS_PAINT;
+    update_queue_shm( queue );
 
     if (!is_signaled( queue ))
         fast_reset_event( queue->fast_sync );
@@ -3150,6 +3246,7 @@ DECL_HANDLER(get_message)
     if (get_win == -1 && current->process->idle_event) set_event( current->process->idle_event );
     queue->wake_mask = req->wake_mask;
     queue->changed_mask = req->changed_mask;
+    update_queue_shm( queue );
     fast_reset_event( queue->fast_sync );
     set_error( STATUS_PENDING );  /* FIXME */
     return;
@@ -3536,6 +3633,7 @@ DECL_HANDLER(get_key_state)
         {
             reply->state = desktop->keystate[req->key & 0xff];
             desktop->keystate[req->key & 0xff] &= ~0x40;
+            update_desktop_shm( desktop );
         }
         set_reply_data( desktop->keystate, size );
         release_object( desktop );
@@ -3566,6 +3664,7 @@ DECL_HANDLER(set_key_state)
     if (req->async && (desktop = get_thread_desktop( current, 0 )))
     {
         memcpy( desktop->keystate, get_req_data(), size );
+        update_desktop_shm( desktop );
         release_object( desktop );
     }
 }
@@ -3956,3 +4055,25 @@ DECL_HANDLER(fast_unselect_queue)
 
     release_object( queue );
 }
+
+
+/* get handles to the shared memory of the thread desktop and message queue */
+DECL_HANDLER(get_user_shared_memory)
+{
+    struct msg_queue *queue = get_current_queue();
+    struct desktop *desktop;
+
+    if (!queue || !(desktop = get_thread_desktop( current, 0 ))) return;
+
+    if (desktop->shared_mapping)
+        reply->desktop = alloc_handle( current->process, desktop->shared_mapping, SECTION_MAP_READ, 0 );
+    if (queue->shared)
+    {
+        struct queue_shm_block *block = &queue_shm_blocks[queue->shared_slot / QUEUE_SHM_BLOCK_SLOTS];
+
+        reply->queue = alloc_handle( current->process, block->mapping, SECTION_MAP_READ, 0 );
+        reply->queue_block = queue->shared_slot / QUEUE_SHM_BLOCK_SLOTS;
+        reply->queue_offset = queue->shared_slot % QUEUE_SHM_BLOCK_SLOTS * sizeof(queue_shm_t);
+    }
+    release_object( desktop );
+}
@@ -411,6 +411,7 @@ DECL_HANDLER(get_linux_sync_obj);
 DECL_HANDLER(fast_select_queue);
 DECL_HANDLER(fast_unselect_queue);
 DECL_HANDLER(get_fast_alert_event);
+DECL_HANDLER(get_user_shared_memory);
 
 #ifdef WANT_REQUEST_HANDLERS
 
@@ -709,6 +710,7 @@ static const req_handler req_handlers[REQ_NB_REQUESTS] =
     (req_handler)req_fast_select_queue,
     (req_handler)req_fast_unselect_queue,
     (req_handler)req_get_fast_alert_event,
+    (req_handler)req_get_user_shared_memory,
 };
 
 C_ASSERT( sizeof(abstime_t) == 8 );
@@ -1165,7 +1167,8 @@ C_ASSERT( sizeof(struct get_mapping_info_reply) == 32 );
 C_ASSERT( FIELD_OFFSET(struct get_image_map_address_request, handle) == 12 );
 C_ASSERT( sizeof(struct get_image_map_address_request) == 16 );
 C_ASSERT( FIELD_OFFSET(struct get_image_map_address_reply, addr) == 8 );
-C_ASSERT( sizeof(struct get_image_map_address_reply) == 16 );
+C_ASSERT( FIELD_OFFSET(struct get_image_map_address_reply, reloc_file) == 16 );
+C_ASSERT( sizeof(struct get_image_map_address_reply) == 24 );
 C_ASSERT( FIELD_OFFSET(struct map_view_request, mapping) == 12 );
 C_ASSERT( FIELD_OFFSET(struct map_view_request, access) == 16 );
 C_ASSERT( FIELD_OFFSET(struct map_view_request, base) == 24 );
@@ -2383,6 +2386,12 @@ C_ASSERT( sizeof(struct fast_unselect_queue_request) == 24 );
 C_ASSERT( sizeof(struct get_fast_alert_event_request) == 16 );
 C_ASSERT( FIELD_OFFSET(struct get_fast_alert_event_reply, handle) == 8 );
 C_ASSERT( sizeof(struct get_fast_alert_event_reply) == 16 );
+C_ASSERT( sizeof(struct get_user_shared_memory_request) == 16 );
+C_ASSERT( FIELD_OFFSET(struct get_user_shared_memory_reply, desktop) == 8 );
+C_ASSERT( FIELD_OFFSET(struct get_user_shared_memory_reply, queue) == 12 );
+C_ASSERT( FIELD_OFFSET(struct get_user_shared_memory_reply, queue_block) == 16 );
+C_ASSERT( FIELD_OFFSET(struct get_user_shared_memory_reply, queue_offset) == 20 );
+C_ASSERT( sizeof(struct get_user_shared_memory_reply) == 24 );
 
 #endif  /* WANT_REQUEST_HANDLERS */
 
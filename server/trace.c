@@ -2184,6 +2184,7 @@ static void dump_get_image_map_address_request( const struct get_image_map_addre
 static void dump_get_image_map_address_reply( const struct get_image_map_address_reply *req )
 {
     dump_uint64( " addr=", &req->addr );
+    fprintf( stderr, ", reloc_file=%04x", req->reloc_file );
 }
 
 static void dump_map_view_request( const struct map_view_request *req )
@@ -4655,6 +4656,18 @@ static void dump_get_fast_alert_event_reply( const struct get_fast_alert_event_r
     fprintf( stderr, " handle=%04x", req->handle );
 }
 
+static void dump_get_user_shared_memory_request( const struct get_user_shared_memory_request *req )
+{
+}
+
+static void dump_get_user_shared_memory_reply( const struct get_user_shared_memory_reply *req )
+{
+    fprintf( stderr, " desktop=%04x", req->desktop );
+    fprintf( stderr, ", queue=%04x", req->queue );
+    fprintf( stderr, ", queue_block=%08x", req->queue_block );
+    fprintf( stderr, ", queue_offset=%08x", req->queue_offset );
+}
+
 static const dump_func req_dumpers[REQ_NB_REQUESTS] = {
     (dump_func)dump_new_process_request,
     (dump_func)dump_get_new_process_info_request,
@@ -4948,6 +4961,7 @@ static const dump_func req_dumpers[REQ_NB_REQUESTS] = {
     (dump_func)dump_fast_select_queue_request,
     (dump_func)dump_fast_unselect_queue_request,
     (dump_func)dump_get_fast_alert_event_request,
+    (dump_func)dump_get_user_shared_memory_request,
 };
 
 static const dump_func reply_dumpers[REQ_NB_REQUESTS] = {
@@ -5243,6 +5257,7 @@ static const dump_func reply_dumpers[REQ_NB_REQUESTS] = {
     NULL,
     NULL,
     (dump_func)dump_get_fast_alert_event_reply,
+    (dump_func)dump_get_user_shared_memory_reply,
 };
 
 static const char * const req_names[REQ_NB_REQUESTS] = {
@@ -5538,6 +5553,7 @@ static const char * const req_names[REQ_NB_REQUESTS] = {
     "fast_select_queue",
     "fast_unselect_queue",
     "get_fast_alert_event",
+    "get_user_shared_memory",
 };
 
 static const struct
@@ -5621,6 +5637,7 @@ static const struct
     { "NAME_TOO_LONG",               STATUS_NAME_TOO_LONG },
     { "NETWORK_BUSY",                STATUS_NETWORK_BUSY },
     { "NETWORK_UNREACHABLE",         STATUS_NETWORK_UNREACHABLE },
+    { "NOTIFY_ENUM_DIR",             STATUS_NOTIFY_ENUM_DIR },
     { "NOT_ALL_ASSIGNED",            STATUS_NOT_ALL_ASSIGNED },
     { "NOT_A_DIRECTORY",             STATUS_NOT_A_DIRECTORY },
     { "NOT_FOUND",                   STATUS_NOT_FOUND },
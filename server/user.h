@@ -82,8 +82,24 @@ struct desktop
     unsigned int         users;            /* processes and threads using this desktop */
     struct global_cursor cursor;           /* global cursor information */
     unsigned char        keystate[256];    /* asynchronous key state */
+    unsigned int         hooks_serial;     /* serial of the last change to the hooks */
+    struct object       *shared_mapping;   /* desktop shared memory mapping */
+    desktop_shm_t       *shared;           /* desktop shared memory */
 };
 
+/* shared memory updates, readers retry while the sequence number is odd or has changed */
+
+static inline void shared_write_begin( volatile unsigned int *seq )
+{
+    __atomic_store_n( seq, *seq + 1, __ATOMIC_RELAXED );
+    __atomic_thread_fence( __ATOMIC_RELEASE );
+}
+
+static inline void shared_write_end( volatile unsigned int *seq )
+{
+    __atomic_store_n( seq, *seq + 1, __ATOMIC_RELEASE );
+}
+
 /* user handles functions */
 
 extern user_handle_t alloc_user_handle( void *ptr, enum user_object type );
@@ -108,6 +124,7 @@ extern struct thread *get_first_global_hook( int id );
 /* queue functions */
 
 extern void free_msg_queue( struct thread *thread );
+extern void update_desktop_shm( struct desktop *desktop );
 extern struct hook_table *get_queue_hooks( struct thread *thread );
 extern void set_queue_hooks( struct thread *thread, struct hook_table *hooks );
 extern void inc_queue_paint_count( struct thread *thread, int incr );
@@ -197,6 +214,7 @@ extern int set_input_desktop( struct winstation *winstation, struct desktop *new
 extern struct desktop *get_desktop_obj( struct process *process, obj_handle_t handle, unsigned int access );
 extern struct winstation *get_process_winstation( struct process *process, unsigned int access );
 extern struct desktop *get_thread_desktop( struct thread *thread, unsigned int access );
+extern void invalidate_active_hooks(void);
 extern void connect_process_winstation( struct process *process, struct unicode_str *desktop_path,
                                         struct thread *parent_thread, struct process *parent_process );
 extern void set_process_default_desktop( struct process *process, struct desktop *desktop,
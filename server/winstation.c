@@ -43,6 +43,7 @@
 #define DESKTOP_ALL_ACCESS 0x01ff
 
 static struct list winstation_list = LIST_INIT(winstation_list);
+static unsigned int hooks_serial = 1;
 
 static void winstation_dump( struct object *obj, int verbose );
 static int winstation_close_handle( struct object *obj, struct process *process, obj_handle_t handle );
@@ -223,6 +224,23 @@ struct winstation *get_visible_winstation(void)
     return NULL;
 }
 
+/* let the clients of all desktops know that their active hooks may have changed */
+void invalidate_active_hooks(void)
+{
+    struct winstation *winstation;
+    struct desktop *desktop;
+
+    hooks_serial++;
+    LIST_FOR_EACH_ENTRY( winstation, &winstation_list, struct winstation, entry )
+    {
+        LIST_FOR_EACH_ENTRY( desktop, &winstation->desktops, struct desktop, entry )
+        {
+            desktop->hooks_serial = hooks_serial;
+            update_desktop_shm( desktop );
+        }
+    }
+}
+
 /* retrieve the winstation current input desktop */
 struct desktop *get_input_desktop( struct winstation *winstation )
 {
@@ -296,9 +314,15 @@ static struct desktop *create_desktop( const struct unicode_str *name, unsigned
             list_init( &desktop->threads );
             memset( &desktop->cursor, 0, sizeof(desktop->cursor) );
             memset( desktop->keystate, 0, sizeof(desktop->keystate) );
+            desktop->hooks_serial = hooks_serial;
             list_add_tail( &winstation->desktops, &desktop->entry );
             list_init( &desktop->hotkeys );
             list_init( &desktop->pointers );
+            /* shared memory is an optimization, clients fall back to server calls without it */
+            if (!(desktop->shared_mapping = create_shared_mapping( sizeof(*desktop->shared),
+                                                                   (void **)&desktop->shared )))
+                clear_error();
+            update_desktop_shm( desktop );
         }
         else
         {
@@ -367,6 +391,7 @@ static void desktop_destroy( struct object *obj )
     if (desktop->msg_window) free_window_handle( desktop->msg_window );
     if (desktop->global_hooks) release_object( desktop->global_hooks );
     if (desktop->close_timeout) remove_timeout_user( desktop->close_timeout );
+    if (desktop->shared_mapping) free_shared_mapping( desktop->shared_mapping, (void *)desktop->shared );
     release_object( desktop->winstation );
 }
 